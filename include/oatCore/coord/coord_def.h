@@ -20,6 +20,8 @@
  *
  */
 
+#pragma once
+
 namespace oatCoord {
 
     /**
@@ -0,0 +1,88 @@
+/*
+ * @file coord_footprint.h
+ *
+ * Created on Mon Oct 19 2026
+ * Created by Felix Yuan
+ * Email: FelixYuan.space@gmail.com
+ *
+ *  Copyright (c) 2026 Felix Yuan
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * This part is coverage footprint polygons of satellites
+ *
+ */
+
+#pragma once
+#include "../oat_config.h"
+#include "coord_def.h"
+#include <cstddef>
+#include <vector>
+
+namespace oatCoord {
+
+    /// @brief Footprint polygons of a batch of satellites, owned by the caller and reused between frames
+    struct Footprints
+    {
+        /// @brief vertex number of every polygon
+        size_t vertexNum;
+        /// @brief vertices, polygon i is [i * vertexNum, (i + 1) * vertexNum), clockwise from north
+        ///        seen from above | unit: deg. Longitudes are continuous around the sub-satellite
+        ///        point and may leave [-180, 180], so a polygon never wraps
+        std::vector<double> lon, lat;
+        /// @brief Earth central angle from the sub-satellite point to the edge | unit: deg
+        std::vector<double> radius;
+        /// @brief 1 if the footprint contains a pole; its outline then runs once around the pole
+        ///        and is not a closed ring in lon/lat
+        std::vector<unsigned char> pole;
+
+        Footprints() :vertexNum(0) {}
+
+        //Get polygon number
+        size_t getNum() const {return radius.size();};
+    };
+
+    /**
+     * Visibility footprints (the region seeing the satellite at or above a minimum elevation) on a
+     * spherical Earth of radius WGS84_A.
+     *
+     * The unit circle of the polygon is tabulated once; per satellite the edge radius and the local
+     * north / east / up axes are computed once and the template is rotated onto the sub-satellite
+     * point in one SoA pass, followed by one pass converting the vertices to lon/lat.
+     */
+    class OATCORE_API FootprintGenerator
+    {
+    public:
+        /// @brief Init FootprintGenerator
+        /// @param vertexNum vertices per polygon
+        /// @param minElevation minimum elevation seen from the ground | unit: deg
+        explicit FootprintGenerator(size_t vertexNum = 72, double minElevation = 0.0);
+
+        /// @brief Footprints of n satellites
+        /// @param subPoints sub-satellite points, Altitude is the satellite altitude | unit: deg, deg, meter
+        /// @param footprints [out] resized to n polygons, keeps its capacity
+        void generate(size_t n, const GeoCoord* subPoints, Footprints& footprints);
+
+        //Get vertex number
+        size_t getVertexNum() const {return m_cos.size();};
+        //Get minimum elevation | unit: deg
+        double getMinElevation() const {return m_minElevation;};
+
+    private:
+        double m_minElevation;
+        double m_cosElevation;
+        // unit circle template
+        std::vector<double> m_cos, m_sin;
+        // rotated vertices of one polygon, unit vectors
+        std::vector<double> m_x, m_y, m_z;
+    };
+}
@@ -0,0 +1,117 @@
+/*
+ * @file coord_frame_graph.h
+ *
+ * Created on Mon Oct 19 2026
+ * Created by Felix Yuan
+ * Email: FelixYuan.space@gmail.com
+ *
+ *  Copyright (c) 2026 Felix Yuan
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * This part is the graph of reference frames and their cached composite transforms
+ *
+ */
+
+#pragma once
+#include "../oat_config.h"
+#include "../oat_geometry_types.h"
+#include "coord_def.h"
+#include <cstddef>
+
+namespace oatCoord {
+
+    /// @brief Reference frames of the FrameGraph
+    enum Frame {
+        // true equator, mean equinox; SGP4 output
+        FRAME_TEME = 0,
+        // geocentric celestial reference frame, J2000 equator and equinox (frame bias neglected)
+        FRAME_GCRF,
+        // Earth fixed, ECEFCoord
+        FRAME_ITRF,
+        // topocentric at the site, axes as ENUCoord: x north, y up, z east
+        FRAME_ENU,
+        // local vertical local horizontal of the target: z nadir, y opposite the orbit normal, x = y ^ z
+        FRAME_LVLH,
+        // heliocentric ecliptic J2000, the frame of cls_orbit / cls_PolarCoordinates
+        FRAME_HELIOCENTRIC,
+        FRAME_NUM
+    };
+
+    /**
+     * Connects the reference frames of the project in a tree rooted at GCRF:
+     *
+     *     GCRF - TEME - ITRF - ENU
+     *          |      + LVLH
+     *          + HELIOCENTRIC
+     *
+     * Every transform is a rigid oat::Matrix in the OSG convention (row vectors, p_to = p_from * M,
+     * translation in row 3); all lengths in meters. The transform between two frames is composed
+     * once per time tag, cached, and reused by every later conversion at that tag until the time tag
+     * or a parameter changes, so converting a whole frame of objects costs one matrix product each.
+     *
+     * The one JD is used as UT1 for the Earth rotation and as TT for precession / nutation. Precession
+     * is IAU-76, nutation the four leading IAU-80 terms (about 0.5 arcsec), the Sun the Astronomical
+     * Almanac low precision series (about 0.01 deg).
+     *
+     * Not thread safe, use one graph per thread.
+     */
+    class OATCORE_API FrameGraph
+    {
+    public:
+        FrameGraph();
+
+        /// @brief Site of FRAME_ENU, GeoCoord on WGS-84
+        void setSite(const GeoCoord& site);
+        /// @brief Target of FRAME_LVLH, TEME state at the time tag in use | unit: meter, m/s
+        void setLvlhTarget(const oat::Vec3& position, const oat::Vec3& velocity);
+        /// @brief Polar motion of FRAME_ITRF | unit: rad
+        void setPolarMotion(double xp, double yp);
+
+        /// @brief Transform from -> to at jd, valid until the next call with another time tag or parameter
+        const oat::Matrix& getTransform(Frame from, Frame to, double jd);
+        /// @brief Rotation part of getTransform as a Quat (q * v rotates a from-vector into to)
+        oat::Quat getRotation(Frame from, Frame to, double jd) {return getTransform(from, to, jd).getRotate();};
+
+        /// @brief Position in from to position in to | unit: meter
+        oat::Vec3 transform(Frame from, Frame to, double jd, const oat::Vec3& position) {return getTransform(from, to, jd).preMult(position);};
+        /// @brief Direction in from to direction in to, rotation only. Velocities between frames rotating
+        ///        against each other also need the transport term, e.g. temeToEcef for TEME / ITRF
+        oat::Vec3 transformDirection(Frame from, Frame to, double jd, const oat::Vec3& direction) {return oat::Matrix::transform3x3(direction, getTransform(from, to, jd));};
+
+        /// @brief Batch positions, one composite matrix for all points. Input and output may alias.
+        void transform(Frame from, Frame to, double jd, size_t n, const double* x, const double* y, const double* z,
+                       double* ox, double* oy, double* oz);
+
+        //Get number of composite transforms built so far, the rest came from the cache
+        size_t getBuildNum() const {return m_buildNum;};
+
+    private:
+        // drop every cached transform
+        void invalidate();
+        // transform of frame to the root GCRF at the current time tag
+        const oat::Matrix& toRoot(Frame frame);
+        // transform of frame to its parent
+        oat::Matrix toParent(Frame frame) const;
+
+        double m_jd;
+        double m_xp, m_yp;
+        GeoCoord m_site;
+        oat::Vec3 m_targetPosition, m_targetVelocity;
+
+        oat::Matrix m_toRoot[FRAME_NUM];
+        bool m_bRootValid[FRAME_NUM];
+        oat::Matrix m_composite[FRAME_NUM][FRAME_NUM];
+        bool m_bCompositeValid[FRAME_NUM][FRAME_NUM];
+        size_t m_buildNum;
+    };
+}
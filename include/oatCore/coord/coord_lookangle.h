@@ -0,0 +1,120 @@
+/*
+ * @file coord_lookangle.h
+ *
+ * Created on Mon Oct 19 2026
+ * Created by Felix Yuan
+ * Email: FelixYuan.space@gmail.com
+ *
+ *  Copyright (c) 2026 Felix Yuan
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * This part is topocentric look angles of many satellites from many ground stations
+ *
+ */
+
+#pragma once
+#include "../oat_config.h"
+#include "coord_def.h"
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace oatCoord {
+
+    /// @brief Look angle of one satellite from one station
+    struct LookAngle
+    {
+        /// @brief station index, see LookAngleEngine::addStation
+        size_t station;
+        /// @brief satellite index in the evaluated arrays
+        size_t satellite;
+        /// @brief Azimuth, clockwise from north | unit: deg | range [0, 360)
+        double azimuth;
+        /// @brief Elevation above the local horizon | unit: deg | range [-90, 90]
+        double elevation;
+        /// @brief Slant range | unit: meter
+        double range;
+        /// @brief Range rate, positive when receding | unit: m/s
+        double rangeRate;
+    };
+
+    /**
+     * Azimuth / elevation / range / range rate of a satellite catalog from a set of ground stations.
+     *
+     * The ECEF -> ENU rotation of every station is computed once in addStation(). evaluate() walks
+     * the station x satellite matrix in tiles of satellites small enough to stay in L1 across all
+     * stations; per tile and station the topocentric vectors are computed in one branch free SoA
+     * pass, and only the pairs above the station's elevation mask get their angles evaluated and
+     * are streamed to the sink in batches.
+     *
+     *     LookAngleEngine engine;
+     *     engine.addStation(GeoCoord(116.4, 39.9, 50.0), 10.0);
+     *     engine.evaluate(n, x, y, z, vx, vy, vz, [](const LookAngle* angles, size_t count) {...});
+     *
+     * Scratch buffers are reused between calls, so one engine must not evaluate on two threads at once.
+     */
+    class OATCORE_API LookAngleEngine
+    {
+    public:
+        /// @brief Receives a batch of results, the pointer is valid during the call only
+        typedef std::function<void(const LookAngle* angles, size_t n)> Sink;
+
+        /// @brief Init LookAngleEngine
+        /// @param tileSize satellites per tile
+        /// @param batchSize results per sink call at most
+        explicit LookAngleEngine(size_t tileSize = 256, size_t batchSize = 1024);
+
+        /// @brief Add a ground station
+        /// @param site station location on WGS-84
+        /// @param minElevation elevation mask, only satellites at or above it are reported | unit: deg
+        /// @return station index
+        size_t addStation(const GeoCoord& site, double minElevation = 0.0);
+
+        //Get station number
+        size_t getStationNum() const {return m_siteX.size();};
+
+        /// @brief Topocentric position of an ECEF point from a station, x north, y up, z east (ENUCoord)
+        ENUCoord toENU(size_t station, const ECEFCoord& position) const;
+
+        /**
+         * @brief Look angles of n satellites from all stations, streamed to sink
+         * @param x, y, z ECEF positions | unit: meter
+         * @param vx, vy, vz ECEF velocities, NULL gives a range rate of 0 | unit: m/s
+         * @param sink receives the results, station major within a tile
+         * @param bApplyMask false reports every pair regardless of the elevation masks
+         */
+        void evaluate(size_t n, const double* x, const double* y, const double* z,
+                      const double* vx, const double* vy, const double* vz,
+                      const Sink& sink, bool bApplyMask = true);
+
+    private:
+        void flush(const Sink& sink);
+
+        size_t m_tileSize;
+        size_t m_batchSize;
+
+        // station ECEF position, meter
+        std::vector<double> m_siteX, m_siteY, m_siteZ;
+        // rows of the ECEF -> ENU rotation: east, north, up
+        std::vector<double> m_eastX, m_eastY;
+        std::vector<double> m_northX, m_northY, m_northZ;
+        std::vector<double> m_upX, m_upY, m_upZ;
+        // sin of the elevation mask
+        std::vector<double> m_sinMask;
+
+        // per tile topocentric scratch
+        std::vector<double> m_east, m_north, m_up, m_range, m_rangeRate;
+        std::vector<LookAngle> m_results;
+        size_t m_resultNum;
+    };
+}
@@ -0,0 +1,82 @@
+/*
+ * @file coord_polar.h
+ *
+ * Created on Mon Oct 19 2026
+ * Created by Felix Yuan
+ * Email: FelixYuan.space@gmail.com
+ *
+ *  Copyright (c) 2026 Felix Yuan
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * This part is batch relative spherical positions, the array form of cls_PolarCoordinates::Convert
+ *
+ */
+
+#pragma once
+#include "../oat_config.h"
+#include <cstddef>
+
+namespace oatCoord {
+
+    /**
+     * Positions of bodies relative to one observer, both given in spherical coordinates about the
+     * same origin (the heliocentric frame of cls_orbit / cls_PolarCoordinates): radius, phi the
+     * azimuth in the xy plane and theta the angle from +z, in rad.
+     *
+     * Same result as cls_PolarCoordinates::Convert with the observer as its argument: the distance
+     * from the observer to the body, and the direction angles of the difference vector minus the
+     * observer's own phi and theta. The azimuth comes from atan2 and keeps its quadrant where
+     * Convert's atan folds it into (-pi/2, pi/2); theta is atan2 based as well, which stays
+     * accurate near the poles.
+     *
+     * The observer's position and sin/cos are computed once at construction, every body costs one
+     * sin/cos pair per angle, a sqrt and two atan2. Reuse the observer for all bodies of a frame.
+     */
+    class OATCORE_API PolarObserver
+    {
+    public:
+        /// @brief Init PolarObserver
+        /// @param radius observer distance from the origin
+        /// @param phi observer azimuth | unit: rad
+        /// @param theta observer angle from +z | unit: rad
+        PolarObserver(double radius, double phi, double theta);
+
+        /**
+         * @brief Relative positions of n bodies, SoA arrays. Input and output may alias.
+         * @param radius, phi, theta [in] body positions about the origin, same units as the observer
+         * @param oRadius [out] distance from the observer
+         * @param oPhi [out] azimuth of the body seen from the observer minus the observer's phi,
+         *        (-pi, pi] - phi | unit: rad
+         * @param oTheta [out] angle from +z of the body seen from the observer minus the observer's
+         *        theta, [0, pi] - theta | unit: rad
+         */
+        void convert(size_t n, const double* radius, const double* phi, const double* theta,
+                     double* oRadius, double* oPhi, double* oTheta) const;
+
+        //Get observer radius
+        double getRadius() const {return m_radius;};
+        //Get observer phi
+        double getPhi() const {return m_phi;};
+        //Get observer theta
+        double getTheta() const {return m_theta;};
+
+    private:
+        double m_radius;
+        double m_phi;
+        double m_theta;
+        // observer cartesian position
+        double m_x;
+        double m_y;
+        double m_z;
+    };
+}
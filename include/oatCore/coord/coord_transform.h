@@ -0,0 +1,137 @@
+/*
+ * @file coord_transform.h
+ *
+ * Created on Mon Oct 19 2026
+ * Created by Felix Yuan
+ * Email: FelixYuan.space@gmail.com
+ *
+ *  Copyright (c) 2026 Felix Yuan
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * This part is batch transforms between coordinate frames
+ *
+ */
+
+#pragma once
+#include "../oat_config.h"
+#include "coord_def.h"
+#include <cstddef>
+
+namespace oatCoord {
+
+    /// @brief Earth rotation rate | unit: rad/s
+    const double EARTH_ROTATION_RATE = 7.292115146706979e-5;
+    /// @brief WGS-84 semi-major axis | unit: meter
+    const double WGS84_A = 6378137.0;
+    /// @brief WGS-84 flattening
+    const double WGS84_F = 1.0 / 298.257223563;
+
+    /**
+     * Orientation of the Earth at one epoch, the rotation between TEME (SGP4 output) and ECEF.
+     * GMST and the polar motion matrix are computed once here and shared by every object converted
+     * at that epoch.
+     *
+     * TEME -> PEF is a rotation by GMST (IAU-82, gstime_SGP4) about z, PEF -> ECEF is the polar motion
+     * rotation by xp, yp; velocities carry the Earth rotation term w x r.
+     */
+    struct OATCORE_API EarthOrientation
+    {
+        /// @brief Greenwich mean sidereal time | unit: rad
+        double gmst;
+        /// @brief cos / sin of gmst
+        double cosGmst;
+        double sinGmst;
+        /// @brief Earth rotation rate corrected by the length of day | unit: rad/s
+        double rotationRate;
+        /// @brief whether the polar motion rotation is applied
+        bool bPolarMotion;
+        /// @brief polar motion, ECEF = polar * PEF, row major
+        double polar[3][3];
+
+        /// @brief Init EarthOrientation
+        /// @param jdut1 epoch, UT1 Julian Day (UTC is fine without EOP data)
+        /// @param xp polar motion x | unit: rad
+        /// @param yp polar motion y | unit: rad
+        /// @param lod excess length of day | unit: s
+        EarthOrientation(double jdut1, double xp = 0.0, double yp = 0.0, double lod = 0.0);
+    };
+
+    /**
+     * @brief TEME to ECEF for n objects at the epoch of orientation, SoA arrays.
+     *        Any length unit; velocities are in that unit per second. Input and output may alias.
+     * @param orientation Earth orientation at the epoch of all objects
+     * @param n object number
+     * @param x, y, z [in] TEME positions
+     * @param vx, vy, vz [in] TEME velocities, may be NULL when ovx, ovy, ovz are NULL
+     * @param ox, oy, oz [out] ECEF positions
+     * @param ovx, ovy, ovz [out] ECEF velocities, may be NULL to skip velocities
+     */
+    OATCORE_API void temeToEcef(const EarthOrientation& orientation, size_t n,
+                                const double* x, const double* y, const double* z,
+                                const double* vx, const double* vy, const double* vz,
+                                double* ox, double* oy, double* oz,
+                                double* ovx, double* ovy, double* ovz);
+
+    /**
+     * @brief ECEF to TEME for n objects at the epoch of orientation, the inverse of temeToEcef.
+     */
+    OATCORE_API void ecefToTeme(const EarthOrientation& orientation, size_t n,
+                                const double* x, const double* y, const double* z,
+                                const double* vx, const double* vy, const double* vz,
+                                double* ox, double* oy, double* oz,
+                                double* ovx, double* ovy, double* ovz);
+
+    /**
+     * @brief TEME position / velocity in km, km/s (OrbitModel_SGP4 output) to ECEFCoord in meter, m/s
+     * @param velocity [out] may be NULL
+     */
+    OATCORE_API void temeToEcef(const EarthOrientation& orientation, size_t n,
+                                const double* x, const double* y, const double* z,
+                                const double* vx, const double* vy, const double* vz,
+                                ECEFCoord* position, ECEFCoord* velocity);
+
+    /**
+     * @brief TEME to ECEF positions of n points, each at its own epoch (e.g. a time series of one
+     *        object), without polar motion. GMST is evaluated per point.
+     * @param jdut1 [in] epoch of point i, UT1 Julian Day
+     */
+    OATCORE_API void temeToEcef(size_t n, const double* jdut1,
+                                const double* x, const double* y, const double* z,
+                                double* ox, double* oy, double* oz);
+
+    /**
+     * @brief ECEF to WGS-84 geodetic for n points, closed form (Vermeille 2004), no iteration.
+     *        Sub-millimeter from the surface to far beyond GEO; not valid within ~43 km of the
+     *        Earth's center. Input and output may not alias.
+     * @param x, y, z [in] ECEF | unit: meter
+     * @param lon, lat [out] longitude [-180, 180], latitude [-90, 90] | unit: deg
+     * @param alt [out] height above the ellipsoid | unit: meter
+     */
+    OATCORE_API void ecefToGeodetic(size_t n, const double* x, const double* y, const double* z,
+                                    double* lon, double* lat, double* alt);
+
+    /**
+     * @brief WGS-84 geodetic to ECEF for n points
+     * @param lon, lat [in] | unit: deg
+     * @param alt [in] height above the ellipsoid | unit: meter
+     * @param x, y, z [out] ECEF | unit: meter
+     */
+    OATCORE_API void geodeticToEcef(size_t n, const double* lon, const double* lat, const double* alt,
+                                    double* x, double* y, double* z);
+
+    /// @brief ECEFCoord to GeoCoord for n points, see ecefToGeodetic
+    OATCORE_API void ecefToGeodetic(size_t n, const ECEFCoord* ecef, GeoCoord* geo);
+
+    /// @brief GeoCoord to ECEFCoord for n points, see geodeticToEcef
+    OATCORE_API void geodeticToEcef(size_t n, const GeoCoord* geo, ECEFCoord* ecef);
+}
@@ -0,0 +1,100 @@
+/*
+ * @file oat_calendar.h
+ *
+ * Created on Mon Oct 19 2026
+ * Created by Felix Yuan
+ * Email: FelixYuan.space@gmail.com
+ *
+ *  Copyright (c) 2026 Felix Yuan
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * This part is batch calendar / Julian date conversion and ISO-8601 timestamps
+ *
+ */
+
+#pragma once
+#include "oat_config.h"
+#include "oat_julian_date.h"
+#include <cstddef>
+
+namespace oat
+{
+    /// @brief Proleptic Gregorian calendar date and time of day, resolved to the microsecond
+    struct CalendarTime {
+        int year;
+        // [1, 12]
+        int month;
+        // [1, 31]
+        int day;
+        // [0, 23]
+        int hour;
+        // [0, 59]
+        int minute;
+        // [0, 59], 60 only on a leap second
+        int second;
+        // [0, 999999]
+        int microsecond;
+    };
+
+    /// @brief Characters of an ISO-8601 timestamp "YYYY-MM-DDTHH:MM:SS.ffffffZ", without the terminating zero
+    const size_t ISO8601_SIZE = 27;
+
+    /*
+     * Batch conversions for exports and ingest of large timestamp columns. Unlike Cal2jd / Jd2Cal
+     * and jday_SGP4 / invjday_SGP4 they are integer only past the rounding of the day fraction to
+     * microseconds (Hinnant's days from civil), have no data dependent branches, and so run as
+     * tight loops the compiler can unroll and vectorize.
+     *
+     * The calendar is proleptic Gregorian for every date, times are taken as is (no leap second
+     * handling, a second of 60 carries into the next minute). Input and output may not alias.
+     */
+
+    /// @brief Calendar times to two part Julian dates
+    OATCORE_API void calendarToJd(const CalendarTime* cal, size_t n, JulianDate* jd);
+    /// @brief Calendar times to single JD
+    OATCORE_API void calendarToJd(const CalendarTime* cal, size_t n, double* jd);
+
+    /// @brief Two part Julian dates to calendar times, rounded to the microsecond
+    OATCORE_API void jdToCalendar(const JulianDate* jd, size_t n, CalendarTime* cal);
+    /// @brief Single JD to calendar times, rounded to the microsecond
+    OATCORE_API void jdToCalendar(const double* jd, size_t n, CalendarTime* cal);
+
+    /**
+     * @brief Write cal as "YYYY-MM-DDTHH:MM:SS.ffffffZ"
+     * @param text [out] ISO8601_SIZE characters and a terminating zero
+     * @return false if the year is outside of [0, 9999], text is left untouched then
+     */
+    OATCORE_API bool formatIso8601(const CalendarTime& cal, char* text);
+
+    /**
+     * @brief Write n dates as ISO-8601 timestamps, fixed width records one after another
+     * @param text [out] n * (ISO8601_SIZE + 1) characters, record i at text + i * (ISO8601_SIZE + 1)
+     * @return number of records written; less than n if date i is out of range
+     */
+    OATCORE_API size_t formatIso8601(const JulianDate* jd, size_t n, char* text);
+
+    /**
+     * @brief Parse an ISO-8601 UTC timestamp, the fast path for the shapes exports write:
+     *        "YYYY-MM-DD", "YYYY-MM-DDTHH:MM:SS" with an optional fraction of any length and an
+     *        optional trailing 'Z'. A space may stand for the 'T'. Fraction digits past the
+     *        microsecond are dropped.
+     * @return false if text has any other shape or a field is out of range
+     */
+    OATCORE_API bool parseIso8601(const char* text, CalendarTime& cal);
+
+    /**
+     * @brief Parse n ISO-8601 timestamps to two part Julian dates, see parseIso8601
+     * @return number of timestamps parsed; less than n if text[i] is not valid
+     */
+    OATCORE_API size_t parseIso8601(const char* const* text, size_t n, JulianDate* jd);
+}
@@ -19,7 +19,20 @@
  * If not, see <https://www.gnu.org/licenses/>.
  *
  */
-
+#pragma once
 
 //if use float type for geometry types(default is double)
-//#define USE_GEOMETRY_FLOAT_TYPE
\ No newline at end of file
+//#define USE_GEOMETRY_FLOAT_TYPE
+
+//export macro of oatCore
+#ifndef OATCORE_API
+#if defined(_WIN32)
+#ifdef oatCore_EXPORTS
+#define OATCORE_API __declspec(dllexport)
+#else
+#define OATCORE_API __declspec(dllimport)
+#endif
+#else
+#define OATCORE_API
+#endif
+#endif
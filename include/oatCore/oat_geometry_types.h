@@ -24,6 +24,7 @@
  * OSG is also licensed under the LGPL.
  *
  */
+#pragma once
 
 #include <cmath>
 #include <iostream>
@@ -788,6 +789,8 @@ namespace oat {
             makeRotate(angle1, axis1, angle2, axis2, angle3, axis3);
         }
 
+        inline Quat(const Quat& v) = default;
+
         inline Quat& operator = (const Quat& v) { _v[0] = v._v[0];  _v[1] = v._v[1]; _v[2] = v._v[2]; _v[3] = v._v[3]; return *this; }
 
         inline bool operator == (const Quat& v) const { return _v[0] == v._v[0] && _v[1] == v._v[1] && _v[2] == v._v[2] && _v[3] == v._v[3]; }
@@ -1054,5 +1057,312 @@ namespace oat {
 
     };    // end of class prototype  
 
+    inline void Quat::slerp(value_type t, const Quat& from, const Quat& to)
+    {
+        const double epsilon = 0.00001;
+        double omega, cosomega, sinomega, scale_from, scale_to;
+
+        Quat quatTo(to);
+
+        cosomega = from.asVec4() * to.asVec4();
+
+        if (cosomega < 0.0)
+        {
+            cosomega = -cosomega;
+            quatTo = -to;
+        }
+
+        if ((1.0 - cosomega) > epsilon)
+        {
+            omega = acos(cosomega);  // 0 <= omega <= Pi (see man acos)
+            sinomega = sin(omega);  // this sinomega should always be +ve so
+            // could try sinomega=sqrt(1-cosomega*cosomega) to avoid a sin()?
+            scale_from = sin((1.0 - t) * omega) / sinomega;
+            scale_to = sin(t * omega) / sinomega;
+        }
+        else
+        {
+            /* --------------------------------------------------
+               The ends of the vectors are very close
+               we can use simple linear interpolation - no need
+               to worry about the "spherical" interpolation
+               -------------------------------------------------- */
+            scale_from = 1.0 - t;
+            scale_to = t;
+        }
+
+        *this = (from * scale_from) + (quatTo * scale_to);
+
+        // so that we get a Vec4
+    }
+
+
+    /* ----------------------------------------------------------------------
+       Matrix methods used by the frame transforms, OSG implementation.
+       OSG convention: row vectors, v' = v * M, translation in row 3, and
+       the transform "A then B" is A * B.
+       ---------------------------------------------------------------------- */
+    inline Matrix::Matrix(value_type a00, value_type a01, value_type a02, value_type a03,
+        value_type a10, value_type a11, value_type a12, value_type a13,
+        value_type a20, value_type a21, value_type a22, value_type a23,
+        value_type a30, value_type a31, value_type a32, value_type a33)
+    {
+        set(a00, a01, a02, a03,
+            a10, a11, a12, a13,
+            a20, a21, a22, a23,
+            a30, a31, a32, a33);
+    }
+
+    inline void Matrix::set(value_type a00, value_type a01, value_type a02, value_type a03,
+        value_type a10, value_type a11, value_type a12, value_type a13,
+        value_type a20, value_type a21, value_type a22, value_type a23,
+        value_type a30, value_type a31, value_type a32, value_type a33)
+    {
+        _mat[0][0] = a00; _mat[0][1] = a01; _mat[0][2] = a02; _mat[0][3] = a03;
+        _mat[1][0] = a10; _mat[1][1] = a11; _mat[1][2] = a12; _mat[1][3] = a13;
+        _mat[2][0] = a20; _mat[2][1] = a21; _mat[2][2] = a22; _mat[2][3] = a23;
+        _mat[3][0] = a30; _mat[3][1] = a31; _mat[3][2] = a32; _mat[3][3] = a33;
+    }
+
+    inline void Matrix::makeIdentity()
+    {
+        set(1.0, 0.0, 0.0, 0.0,
+            0.0, 1.0, 0.0, 0.0,
+            0.0, 0.0, 1.0, 0.0,
+            0.0, 0.0, 0.0, 1.0);
+    }
+
+    inline Matrix Matrix::identity(void)
+    {
+        Matrix m;
+        m.makeIdentity();
+        return m;
+    }
+
+    inline void Matrix::setRotate(const Quat& q)
+    {
+        double length2 = q.length2();
+        if (fabs(length2) <= 1e-300)
+        {
+            _mat[0][0] = 0.0; _mat[1][0] = 0.0; _mat[2][0] = 0.0;
+            _mat[0][1] = 0.0; _mat[1][1] = 0.0; _mat[2][1] = 0.0;
+            _mat[0][2] = 0.0; _mat[1][2] = 0.0; _mat[2][2] = 0.0;
+            return;
+        }
+
+        // normalize quat if required
+        double rlength2 = length2 != 1.0 ? 2.0 / length2 : 2.0;
+        double x2 = rlength2 * q._v[0];
+        double y2 = rlength2 * q._v[1];
+        double z2 = rlength2 * q._v[2];
+        double xx = q._v[0] * x2;
+        double xy = q._v[0] * y2;
+        double xz = q._v[0] * z2;
+        double yy = q._v[1] * y2;
+        double yz = q._v[1] * z2;
+        double zz = q._v[2] * z2;
+        double wx = q._v[3] * x2;
+        double wy = q._v[3] * y2;
+        double wz = q._v[3] * z2;
+
+        _mat[0][0] = 1.0 - (yy + zz);
+        _mat[1][0] = xy - wz;
+        _mat[2][0] = xz + wy;
+
+        _mat[0][1] = xy + wz;
+        _mat[1][1] = 1.0 - (xx + zz);
+        _mat[2][1] = yz - wx;
+
+        _mat[0][2] = xz - wy;
+        _mat[1][2] = yz + wx;
+        _mat[2][2] = 1.0 - (xx + yy);
+    }
+
+    inline void Matrix::makeRotate(const Quat& q)
+    {
+        makeIdentity();
+        setRotate(q);
+    }
+
+    inline Matrix Matrix::rotate(const Quat& quat)
+    {
+        Matrix m;
+        m.makeRotate(quat);
+        return m;
+    }
+
+    inline Quat Matrix::getRotate() const
+    {
+        Quat q;
+        double tq[4];
+        // use tq to store the largest trace
+        tq[0] = 1 + _mat[0][0] + _mat[1][1] + _mat[2][2];
+        tq[1] = 1 + _mat[0][0] - _mat[1][1] - _mat[2][2];
+        tq[2] = 1 - _mat[0][0] + _mat[1][1] - _mat[2][2];
+        tq[3] = 1 - _mat[0][0] - _mat[1][1] + _mat[2][2];
+
+        int j = 0;
+        for (int i = 1; i < 4; ++i) j = (tq[i] > tq[j]) ? i : j;
+
+        if (j == 0)
+        {
+            q._v[3] = tq[0];
+            q._v[0] = _mat[1][2] - _mat[2][1];
+            q._v[1] = _mat[2][0] - _mat[0][2];
+            q._v[2] = _mat[0][1] - _mat[1][0];
+        }
+        else if (j == 1)
+        {
+            q._v[3] = _mat[1][2] - _mat[2][1];
+            q._v[0] = tq[1];
+            q._v[1] = _mat[0][1] + _mat[1][0];
+            q._v[2] = _mat[2][0] + _mat[0][2];
+        }
+        else if (j == 2)
+        {
+            q._v[3] = _mat[2][0] - _mat[0][2];
+            q._v[0] = _mat[0][1] + _mat[1][0];
+            q._v[1] = tq[2];
+            q._v[2] = _mat[1][2] + _mat[2][1];
+        }
+        else
+        {
+            q._v[3] = _mat[0][1] - _mat[1][0];
+            q._v[0] = _mat[2][0] + _mat[0][2];
+            q._v[1] = _mat[1][2] + _mat[2][1];
+            q._v[2] = tq[3];
+        }
+
+        double s = sqrt(0.25 / tq[j]);
+        q._v[3] *= s;
+        q._v[0] *= s;
+        q._v[1] *= s;
+        q._v[2] *= s;
+        return q;
+    }
+
+    inline void Matrix::setTrans(value_type tx, value_type ty, value_type tz)
+    {
+        _mat[3][0] = tx;
+        _mat[3][1] = ty;
+        _mat[3][2] = tz;
+    }
+
+    inline void Matrix::setTrans(const Vec3& v)
+    {
+        setTrans(v.x(), v.y(), v.z());
+    }
+
+    inline void Matrix::mult(const Matrix& lhs, const Matrix& rhs)
+    {
+        if (&lhs == this || &rhs == this)
+        {
+            Matrix temp(*this);
+            mult(&lhs == this ? temp : lhs, &rhs == this ? temp : rhs);
+            return;
+        }
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int col = 0; col < 4; ++col)
+            {
+                _mat[row][col] = lhs._mat[row][0] * rhs._mat[0][col] + lhs._mat[row][1] * rhs._mat[1][col] +
+                    lhs._mat[row][2] * rhs._mat[2][col] + lhs._mat[row][3] * rhs._mat[3][col];
+            }
+        }
+    }
+
+    inline void Matrix::preMult(const Matrix& other)
+    {
+        Matrix temp(*this);
+        mult(other, temp);
+    }
+
+    inline void Matrix::postMult(const Matrix& other)
+    {
+        Matrix temp(*this);
+        mult(temp, other);
+    }
+
+    inline bool Matrix::transpose(const Matrix& rhs)
+    {
+        Matrix temp(rhs);
+        for (int row = 0; row < 4; ++row)
+        {
+            for (int col = 0; col < 4; ++col)
+            {
+                _mat[row][col] = temp._mat[col][row];
+            }
+        }
+        return true;
+    }
+
+    inline bool Matrix::invert_4x3(const Matrix& rhs)
+    {
+        // invert the 3x3 part by cofactors, then the translation
+        Matrix m(rhs);
+        double c00 = m._mat[1][1] * m._mat[2][2] - m._mat[1][2] * m._mat[2][1];
+        double c01 = m._mat[1][2] * m._mat[2][0] - m._mat[1][0] * m._mat[2][2];
+        double c02 = m._mat[1][0] * m._mat[2][1] - m._mat[1][1] * m._mat[2][0];
+        double det = m._mat[0][0] * c00 + m._mat[0][1] * c01 + m._mat[0][2] * c02;
+        if (fabs(det) < 1e-300) return false;
+        double r = 1.0 / det;
+
+        _mat[0][0] = c00 * r;
+        _mat[0][1] = (m._mat[0][2] * m._mat[2][1] - m._mat[0][1] * m._mat[2][2]) * r;
+        _mat[0][2] = (m._mat[0][1] * m._mat[1][2] - m._mat[0][2] * m._mat[1][1]) * r;
+        _mat[1][0] = c01 * r;
+        _mat[1][1] = (m._mat[0][0] * m._mat[2][2] - m._mat[0][2] * m._mat[2][0]) * r;
+        _mat[1][2] = (m._mat[0][2] * m._mat[1][0] - m._mat[0][0] * m._mat[1][2]) * r;
+        _mat[2][0] = c02 * r;
+        _mat[2][1] = (m._mat[0][1] * m._mat[2][0] - m._mat[0][0] * m._mat[2][1]) * r;
+        _mat[2][2] = (m._mat[0][0] * m._mat[1][1] - m._mat[0][1] * m._mat[1][0]) * r;
+
+        double tx = m._mat[3][0], ty = m._mat[3][1], tz = m._mat[3][2];
+        _mat[3][0] = -(tx * _mat[0][0] + ty * _mat[1][0] + tz * _mat[2][0]);
+        _mat[3][1] = -(tx * _mat[0][1] + ty * _mat[1][1] + tz * _mat[2][1]);
+        _mat[3][2] = -(tx * _mat[0][2] + ty * _mat[1][2] + tz * _mat[2][2]);
+        _mat[0][3] = 0.0; _mat[1][3] = 0.0; _mat[2][3] = 0.0; _mat[3][3] = 1.0;
+        return true;
+    }
+
+    inline Vec3 Matrix::postMult(const Vec3& v) const
+    {
+        value_type d = 1.0 / (_mat[3][0] * v.x() + _mat[3][1] * v.y() + _mat[3][2] * v.z() + _mat[3][3]);
+        return Vec3((_mat[0][0] * v.x() + _mat[0][1] * v.y() + _mat[0][2] * v.z() + _mat[0][3]) * d,
+            (_mat[1][0] * v.x() + _mat[1][1] * v.y() + _mat[1][2] * v.z() + _mat[1][3]) * d,
+            (_mat[2][0] * v.x() + _mat[2][1] * v.y() + _mat[2][2] * v.z() + _mat[2][3]) * d);
+    }
+
+    inline Vec3 Matrix::preMult(const Vec3& v) const
+    {
+        value_type d = 1.0 / (_mat[0][3] * v.x() + _mat[1][3] * v.y() + _mat[2][3] * v.z() + _mat[3][3]);
+        return Vec3((_mat[0][0] * v.x() + _mat[1][0] * v.y() + _mat[2][0] * v.z() + _mat[3][0]) * d,
+            (_mat[0][1] * v.x() + _mat[1][1] * v.y() + _mat[2][1] * v.z() + _mat[3][1]) * d,
+            (_mat[0][2] * v.x() + _mat[1][2] * v.y() + _mat[2][2] * v.z() + _mat[3][2]) * d);
+    }
+
+    inline Vec3 Matrix::operator* (const Vec3& v) const
+    {
+        return postMult(v);
+    }
+
+    inline Vec3 operator* (const Vec3& v, const Matrix& m)
+    {
+        return m.preMult(v);
+    }
+
+    inline Vec3 Matrix::transform3x3(const Vec3& v, const Matrix& m)
+    {
+        return Vec3((m._mat[0][0] * v.x() + m._mat[1][0] * v.y() + m._mat[2][0] * v.z()),
+            (m._mat[0][1] * v.x() + m._mat[1][1] * v.y() + m._mat[2][1] * v.z()),
+            (m._mat[0][2] * v.x() + m._mat[1][2] * v.y() + m._mat[2][2] * v.z()));
+    }
+
+    inline Vec3 Matrix::transform3x3(const Matrix& m, const Vec3& v)
+    {
+        return Vec3((m._mat[0][0] * v.x() + m._mat[0][1] * v.y() + m._mat[0][2] * v.z()),
+            (m._mat[1][0] * v.x() + m._mat[1][1] * v.y() + m._mat[1][2] * v.z()),
+            (m._mat[2][0] * v.x() + m._mat[2][1] * v.y() + m._mat[2][2] * v.z()));
+    }
 
 }
\ No newline at end of file
@@ -0,0 +1,92 @@
+/*
+ * @file oat_julian_date.h
+ *
+ * Created on Mon Oct 19 2026
+ * Created by Felix Yuan
+ * Email: FelixYuan.space@gmail.com
+ *
+ *  Copyright (c) 2026 Felix Yuan
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * This part is the two part Julian date
+ *
+ */
+
+#pragma once
+#include <cmath>
+#include <cstddef>
+
+namespace oat
+{
+    /**
+     * Julian date split into whole days and a day fraction, like jdsatepoch / jdsatepochF of the
+     * elsetrec. A single double JD resolves about 20 us today; the fraction alone resolves about
+     * 10 ps, and differences of two dates subtract the day parts exactly.
+     *
+     * Arithmetic only touches the fraction and renormalizes when it leaves [0, 1), which is a
+     * compare in the common case. Comparison and difference work on unnormalized values too.
+     */
+    struct JulianDate {
+        // whole days, JD
+        double day;
+        // day fraction, [0, 1) when normalized
+        double fraction;
+
+        JulianDate() :day(0.0), fraction(0.0) {}
+        /// @brief Split a single JD
+        explicit JulianDate(double jd) :day(floor(jd)), fraction(jd - floor(jd)) {}
+        /// @brief From day and fraction, e.g. jdsatepoch and jdsatepochF; fraction may be any value
+        JulianDate(double day, double fraction) :day(day), fraction(fraction) {normalize();}
+
+        /// @brief Move whole days of the fraction into day
+        void normalize()
+        {
+            if (fraction >= 1.0 || fraction < 0.0)
+            {
+                double whole = floor(fraction);
+                day += whole;
+                fraction -= whole;
+            }
+        }
+
+        //Get as a single JD, rounds to about 20 us
+        double jd() const {return day + fraction;};
+
+        JulianDate& addDays(double days) {fraction += days; normalize(); return *this;};
+        JulianDate& addSeconds(double seconds) {return addDays(seconds / 86400.0);};
+
+        JulianDate& operator += (double days) {return addDays(days);};
+        JulianDate& operator -= (double days) {return addDays(-days);};
+        JulianDate operator + (double days) const {JulianDate t(*this); return t.addDays(days);};
+        JulianDate operator - (double days) const {JulianDate t(*this); return t.addDays(-days);};
+
+        /// @brief Difference in days, exact in the day parts
+        double operator - (const JulianDate& other) const {return (day - other.day) + (fraction - other.fraction);};
+
+        bool operator < (const JulianDate& other) const {return (*this - other) < 0.0;};
+        bool operator > (const JulianDate& other) const {return (*this - other) > 0.0;};
+        bool operator <= (const JulianDate& other) const {return (*this - other) <= 0.0;};
+        bool operator >= (const JulianDate& other) const {return (*this - other) >= 0.0;};
+        bool operator == (const JulianDate& other) const {return (*this - other) == 0.0;};
+        bool operator != (const JulianDate& other) const {return (*this - other) != 0.0;};
+    };
+
+    /// @brief Minutes from epoch for n dates, e.g. sgp4 tsince
+    inline void minutesSince(const JulianDate& epoch, const JulianDate* jd, size_t n, double* minutes)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            minutes[i] = ((jd[i].day - epoch.day) + (jd[i].fraction - epoch.fraction)) * 1440.0;
+        }
+    }
+}
@@ -0,0 +1,126 @@
+/*
+ * @file oat_memory_arena.h
+ *
+ * Created on Mon Oct 19 2026
+ * Created by Felix Yuan
+ * Email: FelixYuan.space@gmail.com
+ *
+ *  Copyright (c) 2026 Felix Yuan
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * This part is slab memory arena and its std allocator
+ *
+ */
+
+#pragma once
+#include "oat_config.h"
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace oat
+{
+    /**
+     * Bump allocator carving allocations out of large slabs. Memory is given back all at once by
+     * release() or the destructor; deallocate() only rewinds the most recent allocation.
+     * allocate() and deallocate() are serialized by a mutex, so models sharing an arena may grow
+     * their caches from several threads, e.g. lazy cache extension while an OrbitScene frame is
+     * evaluated. release() must not race with any use of the memory.
+     */
+    class OATCORE_API MemoryArena
+    {
+    public:
+        /// @brief Init MemoryArena
+        /// @param slabSize bytes of one slab, larger requests get a slab of their own
+        explicit MemoryArena(size_t slabSize = 1 << 20);
+        ~MemoryArena();
+
+        MemoryArena(const MemoryArena&) = delete;
+        MemoryArena& operator = (const MemoryArena&) = delete;
+
+        /// @brief Allocate size bytes aligned to align (a power of two), throws std::bad_alloc
+        void* allocate(size_t size, size_t align = 16);
+
+        /// @brief Give back memory, only effective for the most recent allocation
+        void deallocate(void* p, size_t size);
+
+        /// @brief Free every slab, everything allocated from the arena becomes invalid
+        void release();
+
+        //Get bytes reserved from the system
+        size_t getReservedSize() const {std::lock_guard<std::mutex> lock(m_mutex); return m_reservedSize;};
+        //Get bytes handed out
+        size_t getUsedSize() const {std::lock_guard<std::mutex> lock(m_mutex); return m_usedSize;};
+
+    private:
+        std::vector<char*> m_slabs;
+        // free range of the current slab
+        char* m_cursor;
+        char* m_end;
+        size_t m_slabSize;
+        size_t m_reservedSize;
+        size_t m_usedSize;
+        mutable std::mutex m_mutex;
+    };
+
+    /**
+     * std allocator drawing from a MemoryArena, or from the heap when the arena is NULL.
+     * Copies of a container fall back to the heap so they never outlive a foreign arena.
+     */
+    template <class T>
+    class ArenaAllocator
+    {
+    public:
+        typedef T value_type;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type propagate_on_container_swap;
+
+        ArenaAllocator(MemoryArena* arena = NULL) :m_arena(arena) {}
+        template <class U>
+        ArenaAllocator(const ArenaAllocator<U>& other) :m_arena(other.getArena()) {}
+
+        T* allocate(size_t n)
+        {
+            if (m_arena == NULL)
+            {
+                return static_cast<T*>(::operator new(n * sizeof(T)));
+            }
+            return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* p, size_t n)
+        {
+            if (m_arena == NULL)
+            {
+                ::operator delete(p);
+                return;
+            }
+            m_arena->deallocate(p, n * sizeof(T));
+        }
+
+        ArenaAllocator select_on_container_copy_construction() const {return ArenaAllocator();};
+
+        //Get arena, NULL for the heap
+        MemoryArena* getArena() const {return m_arena;};
+
+    private:
+        MemoryArena* m_arena;
+    };
+
+    template <class T, class U>
+    bool operator == (const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {return a.getArena() == b.getArena();}
+    template <class T, class U>
+    bool operator != (const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) {return a.getArena() != b.getArena();}
+}
@@ -30,7 +30,7 @@ namespace oat {
     #endif
 
     //Calendar to Julian Date
-    double Cal2jd(int year, int month, int day, int hour, int minute, int second)
+    inline double Cal2jd(int year, int month, int day, int hour, int minute, int second)
     {
         int a = (14 - month) / 12;
         int y = year + 4800 - a;
@@ -41,7 +41,7 @@ namespace oat {
     }
 
     //julian date to calendar
-    void Jd2Cal(double jd, int& year, int& month, int& day, int& hour, int& minute, double& second)
+    inline void Jd2Cal(double jd, int& year, int& month, int& day, int& hour, int& minute, double& second)
     {
         // convert JD to date
         const int JGREG = 15 + 31 * (10 + 12 * 1582); // 格里高利历开始日期
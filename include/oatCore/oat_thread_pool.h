@@ -0,0 +1,70 @@
+/*
+ * @file oat_thread_pool.h
+ *
+ * Created on Mon Oct 19 2026
+ * Created by Felix Yuan
+ * Email: FelixYuan.space@gmail.com
+ *
+ *  Copyright (c) 2026 Felix Yuan
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the 
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3 
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without 
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program. 
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * Small fixed size worker pool shared by the background parts of the toolkit
+ *  
+ */
+
+#pragma once
+#include "oat_config.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace oat
+{
+    class OATCORE_API ThreadPool
+    {
+    public:
+        /// @brief Start the workers
+        /// @param threadNum worker number, 0 use std::thread::hardware_concurrency()
+        explicit ThreadPool(unsigned int threadNum = 0);
+        /// @brief Stop the workers, tasks still queued are dropped
+        ~ThreadPool();
+
+        /// @brief Queue a task, it runs on one of the workers
+        void enqueue(std::function<void()> task);
+
+        /// @brief Block until the queue is empty and no task is running
+        void wait();
+
+        //Get worker number
+        unsigned int size() const {return (unsigned int)m_workers.size();};
+    private:
+        ThreadPool(const ThreadPool&);
+        ThreadPool& operator=(const ThreadPool&);
+
+        void workerLoop();
+
+        std::vector<std::thread> m_workers;
+        std::deque<std::function<void()> > m_tasks;
+        std::mutex m_mutex;
+        //signal workers: new task or stop
+        std::condition_variable m_taskCond;
+        //signal wait(): queue drained
+        std::condition_variable m_idleCond;
+        //running task number
+        unsigned int m_busy;
+        bool m_stop;
+    };
+}
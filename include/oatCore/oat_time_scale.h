@@ -0,0 +1,125 @@
+/*
+ * @file oat_time_scale.h
+ *
+ * Created on Mon Oct 19 2026
+ * Created by Felix Yuan
+ * Email: FelixYuan.space@gmail.com
+ *
+ *  Copyright (c) 2026 Felix Yuan
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * This part is conversion between the UTC, TAI, TT and UT1 time scales
+ *
+ */
+
+#pragma once
+#include "oat_config.h"
+#include "oat_julian_date.h"
+#include "coord/coord_transform.h"
+#include <vector>
+
+namespace oat
+{
+    /// @brief Time scales of TimeScaleService
+    enum TimeScale {
+        TIMESCALE_UTC = 0,
+        TIMESCALE_TAI,
+        TIMESCALE_TT,
+        TIMESCALE_UT1
+    };
+
+    /// @brief Earth orientation parameters of one day
+    struct EopEntry {
+        // MJD (UTC) of the entry
+        double mjd;
+        // polar motion | unit: rad
+        double xp;
+        double yp;
+        // UT1 - UTC | unit: s
+        double dut1;
+        // excess length of day | unit: s
+        double lod;
+    };
+
+    /**
+     * Converts Julian dates between UTC, TAI, TT and UT1 with a leap second table and an Earth
+     * orientation (EOP) table, both kept sorted by date.
+     *
+     * The leap seconds up to 2017 are built in; loadLeapSeconds() replaces them from a
+     * leap-seconds.list (NTP seconds) or IERS Leap_Second.dat (MJD) file. loadEop() reads an IERS
+     * finals / finals2000A file; without EOP data UT1 = UTC and there is no polar motion. Between
+     * two EOP days the values are interpolated linearly, dUT1 across a leap second included.
+     *
+     * Every table remembers the interval of its last lookup and tries it and its neighbours first,
+     * so monotonic streams of dates cost O(1) per conversion; other dates fall back to a binary
+     * search. The cursors make queries non const: use one service per thread (copies are cheap
+     * next to loading).
+     *
+     * Dates before 1972 use the 1972 offset, the pre-1972 rubber second is not modelled.
+     */
+    class OATCORE_API TimeScaleService
+    {
+    public:
+        TimeScaleService();
+
+        /// @brief Replace the leap second table from a file
+        /// @return false if the file can not be read or holds no entry, the table is kept then
+        bool loadLeapSeconds(const char* path);
+
+        /// @brief Replace the EOP table from an IERS finals file
+        /// @return false if the file can not be read or holds no entry, the table is kept then
+        bool loadEop(const char* path);
+
+        //Get leap second entry number
+        size_t getLeapSecondNum() const {return m_leapMjd.size();};
+        //Get EOP entry number
+        size_t getEopNum() const {return m_eop.size();};
+
+        /// @brief TAI - UTC at a UTC date | unit: s
+        double taiMinusUtc(const JulianDate& utc);
+
+        /// @brief EOP at a UTC date, interpolated
+        /// @return false if the date is outside of the table, eop then holds the nearest entry
+        ///         (all 0 without a table)
+        bool eopAt(const JulianDate& utc, EopEntry& eop);
+
+        /// @brief Convert one date between time scales
+        JulianDate convert(const JulianDate& jd, TimeScale from, TimeScale to);
+        /// @brief Convert one single JD between time scales
+        double convert(double jd, TimeScale from, TimeScale to) {return convert(JulianDate(jd), from, to).jd();};
+
+        /// @brief Convert n dates between time scales. Input and output may alias.
+        void convert(const JulianDate* jd, size_t n, TimeScale from, TimeScale to, JulianDate* out);
+        /// @brief Convert n single JD between time scales. Input and output may alias.
+        void convert(const double* jd, size_t n, TimeScale from, TimeScale to, double* out);
+
+        /// @brief Earth orientation at a UTC date for the TEME / ECEF transforms, with UT1 and polar motion
+        oatCoord::EarthOrientation earthOrientation(const JulianDate& utc);
+
+    private:
+        // UTC date to TAI, TT, UT1 or back, seconds added to the date
+        double utcTo(const JulianDate& utc, TimeScale to);
+        // interval of the table holding mjd, starting at cursor; SIZE_MAX before the first entry
+        static size_t find(const std::vector<double>& table, double mjd, size_t& cursor);
+
+        // leap second table: MJD (UTC) from which TAI - UTC is offset
+        std::vector<double> m_leapMjd;
+        std::vector<double> m_leapOffset;
+        size_t m_leapCursor;
+
+        // EOP table, its MJD column kept apart for the lookup
+        std::vector<EopEntry> m_eop;
+        std::vector<double> m_eopMjd;
+        size_t m_eopCursor;
+    };
+}
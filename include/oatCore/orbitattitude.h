@@ -0,0 +1,140 @@
+/*
+ * @file orbitattitude.h
+ *
+ * Created on Mon Oct 19 2026
+ * Created by Felix Yuan
+ * Email: FelixYuan.space@gmail.com
+ *
+ *  Copyright (c) 2026 Felix Yuan
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * This part is attitude laws of orbit models
+ *
+ */
+
+#pragma once
+#include "oat_config.h"
+#include "oat_geometry_types.h"
+#include <cstddef>
+
+namespace oat
+{
+    /**
+     * Attitude law: the orientation of a body as a function of its state.
+     *
+     * The returned quaternion rotates body axes into the frame of the state vectors (TEME for
+     * OrbitModel_SGP4), i.e. q * Vec3(0, 0, 1) is the body z axis in that frame.
+     *
+     * A law is stateless and may be shared by any number of models, see OrbitModel::setAttitudeLaw.
+     */
+    class OATCORE_API AttitudeLaw
+    {
+    public:
+        virtual ~AttitudeLaw();
+
+        /**
+		* @brief Attitude of one body.
+        * @param jd [in] time, Julian Day
+        * @param position [in] position, any unit
+        * @param velocity [in] velocity, any unit
+        * @return body to frame rotation
+        */
+        virtual Quat attitude(double jd, const Vec3& position, const Vec3& velocity) const = 0;
+
+        /**
+		* @brief Attitude of n bodies at the same JD from SoA state vectors, e.g. an OrbitScene::Frame.
+        *        The laws below override it with a branchless loop the compiler can vectorize.
+        * @param jd [in] time, Julian Day
+        * @param n [in] number of bodies
+        * @param x, y, z [in] positions
+        * @param vx, vy, vz [in] velocities
+        * @param q [out] n attitudes
+        */
+        virtual void attitudes(double jd, size_t n, const double* x, const double* y, const double* z,
+                               const double* vx, const double* vy, const double* vz, Quat* q) const;
+    };
+
+    /// @brief Fixed attitude in the frame of the state vectors
+    class OATCORE_API InertialAttitude : public AttitudeLaw
+    {
+    public:
+        explicit InertialAttitude(const Quat& q = Quat()) :m_quat(q) {};
+
+        Quat attitude(double jd, const Vec3& position, const Vec3& velocity) const;
+        void attitudes(double jd, size_t n, const double* x, const double* y, const double* z,
+                       const double* vx, const double* vy, const double* vz, Quat* q) const;
+
+        //Get fixed attitude
+        const Quat& getQuat() const {return m_quat;};
+    private:
+        Quat m_quat;
+    };
+
+    /// @brief Nadir pointing, body axes along LVLH: z to nadir, y to the negative orbit normal,
+    ///        x completes the triad (along velocity for a circular orbit)
+    class OATCORE_API NadirAttitude : public AttitudeLaw
+    {
+    public:
+        Quat attitude(double jd, const Vec3& position, const Vec3& velocity) const;
+        void attitudes(double jd, size_t n, const double* x, const double* y, const double* z,
+                       const double* vx, const double* vy, const double* vz, Quat* q) const;
+    };
+
+    /// @brief Velocity aligned: x along velocity, y to the negative orbit normal, z completes
+    ///        the triad (towards nadir)
+    class OATCORE_API VelocityAttitude : public AttitudeLaw
+    {
+    public:
+        Quat attitude(double jd, const Vec3& position, const Vec3& velocity) const;
+        void attitudes(double jd, size_t n, const double* x, const double* y, const double* z,
+                       const double* vx, const double* vy, const double* vz, Quat* q) const;
+    };
+
+    /// @brief Sun pointing: z to the sun, x along orbit normal x sun so y stays close to the
+    ///        orbit plane. The sun direction is computed once per call.
+    class OATCORE_API SunPointingAttitude : public AttitudeLaw
+    {
+    public:
+        Quat attitude(double jd, const Vec3& position, const Vec3& velocity) const;
+        void attitudes(double jd, size_t n, const double* x, const double* y, const double* z,
+                       const double* vx, const double* vy, const double* vz, Quat* q) const;
+    };
+
+    /// @brief Low precision (~0.01 deg) geocentric sun direction, unit vector in the mean equator
+    ///        and equinox of date, close enough to TEME for attitude and lighting
+    /// @param jd Julian Day
+    OATCORE_API Vec3 sunDirectionAtJD(double jd);
+
+    /// @brief Normalized linear interpolation along the shorter arc, cheaper than slerp and
+    ///        indistinguishable for the small steps between two frames
+    inline Quat nlerp(const Quat& from, const Quat& to, double t)
+    {
+        double s = (from.asVec4() * to.asVec4()) < 0.0 ? -t : t;
+        Quat q = from * (1.0 - t) + to * s;
+        return q / q.length();
+    }
+
+    /// @brief Spherical linear interpolation, see Quat::slerp
+    inline Quat slerp(const Quat& from, const Quat& to, double t)
+    {
+        Quat q;
+        q.slerp(t, from, to);
+        return q;
+    }
+
+    /// @brief nlerp of n attitude pairs with the same t, e.g. between two evaluated frames
+    OATCORE_API void nlerp(const Quat* from, const Quat* to, size_t n, double t, Quat* out);
+
+    /// @brief slerp of n attitude pairs with the same t
+    OATCORE_API void slerp(const Quat* from, const Quat* to, size_t n, double t, Quat* out);
+}
@@ -0,0 +1,123 @@
+/*
+ * @file orbitephemeris.h
+ *
+ * Created on Mon Oct 19 2026
+ * Created by Felix Yuan
+ * Email: FelixYuan.space@gmail.com
+ *
+ *  Copyright (c) 2026 Felix Yuan
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * This part is lazy, batched ephemeris generation
+ *
+ */
+
+#pragma once
+#include "orbitmodel.h"
+#include <iterator>
+
+namespace oat
+{
+    /**
+     * Generates the ephemeris of a model over [beginJD, endJD] lazily, one batch at a time, with
+     * OrbitModel::propagate. Only one batch is alive, so arbitrarily long spans stream in
+     * O(batchSize) memory without touching the model cache.
+     *
+     * Batch wise:
+     *
+     *     EphemerisGenerator gen(model, beginJD, endJD, step);
+     *     while (gen.next())
+     *         writer.write(gen.getBatch());
+     *
+     * or sample wise, the iterator pulls the next batch when the current one is used up:
+     *
+     *     for (const OrbitData& data : EphemerisGenerator(model, beginJD, endJD, step))
+     *         analyse(data);
+     *
+     * Sample i is at beginJD + i * dDeltaTime, the last one not after endJD. Generation stops early
+     * if the model can not propagate, see getFailed().
+     */
+    class OATCORE_API EphemerisGenerator
+    {
+    public:
+        class iterator
+        {
+        public:
+            typedef std::input_iterator_tag iterator_category;
+            typedef OrbitData value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const OrbitData* pointer;
+            typedef const OrbitData& reference;
+
+            iterator(EphemerisGenerator* generator = NULL, size_t i = 0) :m_generator(generator), m_i(i) {}
+
+            reference operator * () const {return m_generator->m_batch[m_i];};
+            pointer operator -> () const {return &m_generator->m_batch[m_i];};
+            iterator& operator ++ ()
+            {
+                if (++m_i == m_generator->m_batchSize)
+                {
+                    m_i = 0;
+                    if (!m_generator->next())
+                    {
+                        m_generator = NULL;
+                    }
+                }
+                return *this;
+            }
+            bool operator == (const iterator& other) const {return m_generator == other.m_generator && m_i == other.m_i;};
+            bool operator != (const iterator& other) const {return !(*this == other);};
+
+        private:
+            EphemerisGenerator* m_generator;
+            size_t m_i;
+        };
+
+        /// @brief Init EphemerisGenerator, nothing is computed before the first batch is pulled
+        /// @param model source model, has to support OrbitModel::propagate and outlive the generator
+        /// @param beginJD span start JD
+        /// @param endJD span end JD
+        /// @param dDeltaTime sample step, JD days
+        /// @param batchSize samples per batch
+        EphemerisGenerator(const OrbitModel& model, double beginJD, double endJD, double dDeltaTime, size_t batchSize = 256);
+
+        /// @brief Compute the next batch
+        /// @return false when the span is done or the model failed
+        bool next();
+
+        //Get the current batch
+        OrbitDataView getBatch() const {return m_batchSize == 0 ? OrbitDataView() : OrbitDataView(&m_batch[0], m_batchSize);};
+        //Get total sample number of the span
+        size_t getSampleNum() const {return m_sampleNum;};
+        //Get whether propagate failed
+        bool getFailed() const {return m_bFailed;};
+
+        /// @brief Iterator at the first sample of the current batch, pulls the first batch if needed
+        iterator begin();
+        iterator end() {return iterator();};
+
+    private:
+        const OrbitModel& m_model;
+        double m_beginJD;
+        double m_deltaTime;
+        size_t m_sampleNum;
+        // index of the first sample after the current batch
+        size_t m_nextSample;
+        bool m_bFailed;
+
+        std::vector<double> m_jd;
+        std::vector<OrbitData> m_batch;
+        // sample number of the current batch
+        size_t m_batchSize;
+    };
+}
@@ -0,0 +1,112 @@
+/*
+ * @file orbitephemeris_cache.h
+ *
+ * Created on Mon Oct 19 2026
+ * Created by Felix Yuan
+ * Email: FelixYuan.space@gmail.com
+ *
+ *  Copyright (c) 2026 Felix Yuan
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * This part is process wide sharing of identical ephemeris caches
+ *
+ */
+
+#pragma once
+#include "orbitmodel.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace oat
+{
+    /// @brief Everything an ephemeris cache depends on
+    struct EphemerisKey {
+        // TLE lines, without line breaks
+        std::string tleLine1st;
+        std::string tleLine2nd;
+        // cache span and step, JD
+        double beginTime;
+        double endTime;
+        double deltaTime;
+        // sgp4 operation mode 'a' or 'i'
+        char opsmode;
+        // sgp4 gravity model (gravconsttype)
+        int gravity;
+
+        bool operator < (const EphemerisKey& other) const;
+    };
+
+    /**
+     * Process wide, reference counted store of immutable ephemeris blocks. Models built from the
+     * same key share one block instead of each propagating and storing its own; the block is freed
+     * with the last model using it. Thread safe.
+     *
+     * Sharing is off by default, turn it on before building the models:
+     *
+     *     EphemerisCache::instance().setEnabled(true);
+     */
+    class OATCORE_API EphemerisCache
+    {
+    public:
+        struct Stats {
+            // lookups answered by a live block
+            unsigned long long hits;
+            // lookups that had to propagate
+            unsigned long long misses;
+            // blocks alive now
+            size_t blocks;
+        };
+
+        typedef std::shared_ptr<const OrbitDataVector> Block;
+
+        //Get the process wide cache
+        static EphemerisCache& instance();
+
+        /// @brief Turn sharing for newly built models on or off, models already built keep their block
+        void setEnabled(bool bEnabled) {m_bEnabled.store(bEnabled);};
+        //Get whether sharing is on
+        bool getEnabled() const {return m_bEnabled.load();};
+
+        /// @brief Live block of key, NULL (counted as a miss) if there is none
+        Block find(const EphemerisKey& key);
+
+        /// @brief Publish data as the block of key. data is moved into the block (copied to the heap if
+        ///        it lives in an arena) and left empty. If another thread published key first, that
+        ///        block is returned instead.
+        Block insert(const EphemerisKey& key, OrbitDataVector& data);
+
+        //Get hit/miss statistics
+        Stats getStats() const;
+        //Reset hit/miss statistics
+        void resetStats();
+
+    private:
+        EphemerisCache();
+        EphemerisCache(const EphemerisCache&);
+        EphemerisCache& operator=(const EphemerisCache&);
+
+        // drop the entries of freed blocks
+        void purge();
+
+        mutable std::mutex m_mutex;
+        std::map<EphemerisKey, std::weak_ptr<const OrbitDataVector> > m_blocks;
+        // entry number after the last purge, purge again when it doubled
+        size_t m_purgeSize;
+        std::atomic<bool> m_bEnabled;
+        unsigned long long m_hits;
+        unsigned long long m_misses;
+    };
+}
@@ -0,0 +1,118 @@
+/*
+ * @file orbitgroundtrack.h
+ *
+ * Created on Mon Oct 19 2026
+ * Created by Felix Yuan
+ * Email: FelixYuan.space@gmail.com
+ *
+ *  Copyright (c) 2026 Felix Yuan
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * This part is ground track generation split at the antimeridian
+ *
+ */
+
+#pragma once
+#include "orbitmodel.h"
+
+namespace oat
+{
+    /// @brief Ground track as lon/lat polylines, owned by the caller and reused between generations
+    struct GroundTrack {
+        // points, WGS-84 geodetic | unit: deg
+        std::vector<double> lon, lat;
+        // JD of every point
+        std::vector<double> jd;
+        // first point of every polyline, polyline s ends where polyline s + 1 starts
+        std::vector<size_t> segments;
+
+        //Get point number
+        size_t getPointNum() const {return lon.size();};
+        //Get polyline number
+        size_t getSegmentNum() const {return segments.size();};
+        //Get point number of polyline s
+        size_t getSegmentSize(size_t s) const {return (s + 1 < segments.size() ? segments[s + 1] : lon.size()) - segments[s];};
+        /// @brief Drop the content, the capacity is kept so the next generation does not allocate
+        void clear() {lon.clear(); lat.clear(); jd.clear(); segments.clear();};
+    };
+
+    /**
+     * Generates the ground track of a model over a time span in one streaming pass.
+     *
+     * The span is propagated in batches with OrbitModel::propagate on a coarse step; a gap whose
+     * points are more than maxAngle apart (seen from the Earth's center) is refined with evenly
+     * spaced extra samples, so fast, low perigee passes get dense points and slow ones sparse.
+     * Positions go TEME -> ECEF -> geodetic with the batch coord transforms.
+     *
+     * A polyline is closed where the track crosses the antimeridian and a new one starts on the other
+     * side; both get the crossing point at exactly +-180 deg. The crossing is found on the ECEF chord
+     * rather than by longitude, so passes over or near a pole are split correctly. A step that jumps
+     * more than 90 deg in longitude without crossing (passing a pole) is routed along the +-90 deg
+     * edge of the map.
+     *
+     * Scratch buffers are owned by the generator and the output by the caller; after the first
+     * generation neither allocates. One generator must not be used on two threads at once.
+     */
+    class OATCORE_API GroundTrackGenerator
+    {
+    public:
+        /// @brief Init GroundTrackGenerator
+        /// @param maxAngle max geocentric angle between consecutive points | unit: deg
+        /// @param batchSize coarse samples propagated per batch
+        /// @param unitToMeter meters per unit of the model positions, 1000 for km (SGP4)
+        explicit GroundTrackGenerator(double maxAngle = 1.0, size_t batchSize = 256, double unitToMeter = 1000.0);
+
+        /**
+         * @brief Ground track of model over [beginJD, endJD] into track
+         * @param model source model, has to support OrbitModel::propagate
+         * @param dDeltaTime coarse step, JD days
+         * @param track [out] cleared and filled
+         * @return false if the model failed to propagate, track then holds the part done so far
+         */
+        bool generate(const OrbitModel& model, double beginJD, double endJD, double dDeltaTime, GroundTrack& track);
+
+    private:
+        // samples and their ECEF / geodetic conversion
+        struct Buffer {
+            std::vector<double> jd;
+            std::vector<OrbitData> data;
+            // ECEF, meter
+            std::vector<double> x, y, z;
+            // geodetic, deg, deg, meter
+            std::vector<double> lon, lat, alt;
+
+            void resize(size_t n);
+        };
+
+        // propagated buffer.data[0, n) at buffer.jd to ECEF and geodetic
+        bool convert(const OrbitModel& model, Buffer& buffer, size_t n);
+        // append point i of buffer, splitting at the antimeridian
+        void append(const Buffer& buffer, size_t i, GroundTrack& track);
+        // push one point, through the pole edge if the step from the previous one jumps in longitude
+        void emit(GroundTrack& track, double lon, double lat, double jd, bool bNewSegment);
+
+        double m_maxAngle;
+        double m_cosMaxAngle;
+        size_t m_batchSize;
+        double m_unitToMeter;
+
+        // coarse samples of the current batch
+        Buffer m_coarse;
+        // extra samples of the gap being refined
+        Buffer m_refine;
+
+        // last appended point
+        bool m_bHasLast;
+        double m_lastJD, m_lastX, m_lastY, m_lastZ;
+    };
+}
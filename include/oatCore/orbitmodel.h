@@ -19,12 +19,19 @@
  * If not, see <https://www.gnu.org/licenses/>.
  *
  */
+#pragma once
+#include "oat_config.h"
 #include "oat_geometry_types.h"
+#include "oat_julian_date.h"
+#include "oat_memory_arena.h"
+#include <cstddef>
 #include <map>
 #include <vector>
 
 namespace oat
 {
+    class AttitudeLaw;
+
     struct OrbitData {
         // julian date
         double jd; 
@@ -33,12 +40,57 @@ namespace oat
         // velocity
         Vec3 velocity; 
     };
-    class OrbitModel
+
+    // orbit data cache, on the heap or in the MemoryArena of an OrbitModelArena
+    typedef std::vector<OrbitData, ArenaAllocator<OrbitData> > OrbitDataVector;
+
+    /// @brief Read only view of contiguous OrbitData, e.g. a window of a model cache. It does not own
+    ///        the data and is invalidated by anything that reallocates the cache (extension, destruction).
+    struct OrbitDataView {
+        // first sample
+        const OrbitData* data;
+        // sample number
+        size_t size;
+
+        OrbitDataView(const OrbitData* data = NULL, size_t size = 0) :data(data), size(size) {}
+
+        const OrbitData* begin() const {return data;};
+        const OrbitData* end() const {return data + size;};
+        bool empty() const {return size == 0;};
+        const OrbitData& operator [] (size_t i) const {return data[i];};
+        const OrbitData& front() const {return data[0];};
+        const OrbitData& back() const {return data[size - 1];};
+    };
+
+    /// @brief Screen space tolerance of adaptive orbit sampling
+    struct SampleTolerance {
+        // max visual error of a segment | unit: pixel
+        double pixelError;
+        // distance from the camera to the orbit | unit: sim unit
+        double cameraDistance;
+        // angle covered by one pixel (vertical fov / viewport height) | unit: rad
+        double pixelAngle;
+        // max angle one segment sweeps seen from the frame origin, i.e. the central body at the
+        // orbit focus (true anomaly for a Keplerian orbit) | unit: rad
+        double maxTurnAngle;
+
+        SampleTolerance(double pixelError = 1.0, double cameraDistance = 1.0, double pixelAngle = 0.001, double maxTurnAngle = 0.5)
+            :pixelError(pixelError), cameraDistance(cameraDistance), pixelAngle(pixelAngle), maxTurnAngle(maxTurnAngle) {}
+    };
+    class OATCORE_API OrbitModel
     {
     public:
-        OrbitModel();
+        /// @brief Init OrbitModel
+        /// @param arena memory of the orbit data cache, NULL for the heap; must outlive the model
+        explicit OrbitModel(MemoryArena* arena = NULL);
         virtual ~OrbitModel();
 
+        // the virtual destructor suppresses the implicit moves, moving hands over the cache without a copy
+        OrbitModel(const OrbitModel&) = default;
+        OrbitModel(OrbitModel&&) noexcept = default;
+        OrbitModel& operator = (const OrbitModel&) = default;
+        OrbitModel& operator = (OrbitModel&&) noexcept = default;
+
         /**
 		* @brief Calculate the world coordinate position of entity at current JD time.
         *        The standard unit of Vec3 depends on the situation, and the celestial body is in kilometers <TODO To be determined>
@@ -57,36 +109,140 @@ namespace oat
 
         /**
 		* @brief Calculate the quaternion of entity at current JD time.
-        *        <TODO To be determined unit>
+        *        Evaluated by the attitude law of the model, see setAttitudeLaw.
         * @param jd [in] time , Time is Julian Day (in days <TODO To be determined > )
-        * @return quatertion at current JD time;
+        * @return quatertion at current JD time, body to position frame rotation;
         */
         virtual Quat quatAtJD(double jd);
 
-        //Get Period
-        virtual double getPeriod() const {return m_period;};
-        //Get enclosing sphere radius
-        virtual double getBoundingRadius() const {return m_boundingRadius;};
-        //Get Oribit data
-        virtual const std::vector<OrbitData>& getOrbitData() const {return orbitData;};
+        /// @brief Set the attitude law used by quatAtJD, it is not owned and may be shared by many models
+        /// @param law attitude law, NULL for the model default
+        void setAttitudeLaw(const AttitudeLaw* law) {m_attitudeLaw = law;};
+        //Get attitude law
+        const AttitudeLaw* getAttitudeLaw() const {return m_attitudeLaw;};
+
+        /**
+		* @brief Calculate positions at a batch of JD times with one virtual call.
+        *        Output component k of sample i is written to x/y/z[i * stride].
+        * @param jd [in] time array, Julian Day
+        * @param n [in] number of times
+        * @param x [out] x components
+        * @param y [out] y components
+        * @param z [out] z components
+        * @param stride [in] distance between two samples in the output arrays (in doubles)
+        */
+        virtual void positionsAtJD(const double* jd, size_t n, double* x, double* y, double* z, size_t stride);
+
+        /**
+		* @brief Calculate velocities at a batch of JD times with one virtual call, see positionsAtJD.
+        */
+        virtual void velocitiesAtJD(const double* jd, size_t n, double* x, double* y, double* z, size_t stride);
+
+        /// @brief Batch positions into an interleaved xyz (AoS) buffer of 3 * n doubles
+        void positionsAtJD(const double* jd, size_t n, double* xyz_out) {positionsAtJD(jd, n, xyz_out, xyz_out + 1, xyz_out + 2, 3);};
+        /// @brief Batch positions into separate x, y, z (SoA) arrays of n doubles
+        void positionsAtJD(const double* jd, size_t n, double* x, double* y, double* z) {positionsAtJD(jd, n, x, y, z, 1);};
+        /// @brief Batch velocities into an interleaved xyz (AoS) buffer of 3 * n doubles
+        void velocitiesAtJD(const double* jd, size_t n, double* xyz_out) {velocitiesAtJD(jd, n, xyz_out, xyz_out + 1, xyz_out + 2, 3);};
+        /// @brief Batch velocities into separate x, y, z (SoA) arrays of n doubles
+        void velocitiesAtJD(const double* jd, size_t n, double* x, double* y, double* z) {velocitiesAtJD(jd, n, x, y, z, 1);};
+
+        /**
+		* @brief Evaluate the model directly at a set of JD times, bypassing the orbit data cache.
+        *        The cache is not touched, so it is safe to call from worker threads while
+        *        the render thread keeps querying the model.
+        * @param jd [in] time array, Julian Day
+        * @param n [in] number of times
+        * @param out [out] n states, same units as positionAtJD/velocityAtJD
+        * @return false if the model can not be evaluated outside of its cache
+        */
+        virtual bool propagate(const double* jd, size_t n, OrbitData* out) const;
+
+        /**
+		* @brief propagate at two part Julian dates, for models that can use the extra precision.
+        *        The default rounds every date to a single JD and calls the double version.
+        */
+        virtual bool propagate(const JulianDate* jd, size_t n, OrbitData* out) const;
+
+        //Get Period | unit: JD days
+        double getPeriod() const {return m_period;};
+        //Get enclosing sphere radius around the central body | unit: unit of positionAtJD
+        double getBoundingRadius() const {return m_boundingRadius;};
+        //Get a heap copy of the orbit data, prefer getOrbitCache() or getOrbitDataView() which do not copy
+        std::vector<OrbitData> getOrbitData() const;
+        //Get orbit data cache, in the arena of the model if it has one
+        virtual const OrbitDataVector& getOrbitCache() const {return orbitData;};
+        //Get a view over the whole orbit data cache
+        OrbitDataView getOrbitDataView() const {const OrbitDataVector& data = getOrbitCache(); return data.empty() ? OrbitDataView() : OrbitDataView(&data[0], data.size());};
+
+        /// @brief View over the cached samples with beginJD <= jd <= endJD, no copy
+        /// @param beginJD window start JD
+        /// @param endJD window end JD
+        OrbitDataView getOrbitDataView(double beginJD, double endJD) const;
         
         /// @brief Orbital interpolation sample, Calculate a fixed number of equal point sets in a period
         /// @param curJD current JD (Angle interpolation, time invalid)
         /// @param ptNum interpolation number
         /// @param mapTime2Position interpolation map
         virtual void sample(double curJD, int ptNum, std::map<double, Vec3>& mapTime2Position);
+
+        /// @brief Same time points as sample(), written straight into a contiguous buffer without allocation
+        /// @param curJD current JD
+        /// @param ptNum interpolation number
+        /// @param xyz [out] interleaved xyz, room for 3 * ptNum values, sim unit relative to origin
+        /// @param origin subtracted from every point (e.g. camera position), sim unit
+        /// @return number of points written
+        size_t sampleInto(double curJD, int ptNum, double* xyz, const Vec3& origin = Vec3());
+
+        /// @brief Float version of sampleInto, the origin is subtracted in double before the
+        ///        cast so camera relative vertices keep their precision
+        size_t sampleInto(double curJD, int ptNum, float* xyz, const Vec3& origin = Vec3());
+
+        /// @brief Curvature adaptive sample of [beginJD, endJD]. A segment whose mid point is too far
+        ///        from its chord is cut into equal pieces in time, as many as the square root of the
+        ///        error ratio asks for (the chord error falls with the square of the length), and
+        ///        into two while it sweeps more than tolerance.maxTurnAngle seen from the frame origin.
+        ///        Pieces are tested again until every segment's mid point projects within
+        ///        tolerance.pixelError, so perigee gets dense points and apogee sparse ones. No allocation.
+        /// @param beginJD span start JD, e.g. curJD - period / 2 for a full ring
+        /// @param endJD span end JD
+        /// @param tolerance screen space tolerance
+        /// @param xyz [out] interleaved xyz, room for 3 * capacity values, sim unit relative to origin
+        /// @param jd [out] optional (may be NULL) JD of every point
+        /// @param capacity max point number, sampling stops early when it is reached
+        /// @param origin subtracted from every point, sim unit
+        /// @return number of points written
+        size_t sampleAdaptive(double beginJD, double endJD, const SampleTolerance& tolerance,
+                              double* xyz, double* jd, size_t capacity, const Vec3& origin = Vec3());
     protected:
-        //orbit period
+        //orbit period, set once by the concrete model
         double m_period;
-        //Orbital enclosing sphere radius
+        //Orbital enclosing sphere radius, set once by the concrete model
         double m_boundingRadius;
         //calc data start time
         double m_beginTime;
         //calc data end time;
         double m_endTime;
         //orbit data cache;
-        std::vector<OrbitData> orbitData;
+        OrbitDataVector orbitData;
+        //attitude law, not owned
+        const AttitudeLaw* m_attitudeLaw;
 
     };
 
-}
\ No newline at end of file
+
+    /**
+     * Devirtualized evaluation of one concrete model type, used by the typed groups of OrbitScene.
+     * The default kernel makes qualified calls, which bind statically instead of through the vtable.
+     * Specialize it for a model type to give the scene a faster kernel.
+     */
+    template <class T>
+    struct ModelKernel
+    {
+        static void evaluate(T* model, double jd, Vec3& position, Vec3& velocity)
+        {
+            position = model->T::positionAtJD(jd);
+            velocity = model->T::velocityAtJD(jd);
+        }
+    };
+}
@@ -0,0 +1,79 @@
+/*
+ * @file orbitmodel_arena.h
+ *
+ * Created on Mon Oct 19 2026
+ * Created by Felix Yuan
+ * Email: FelixYuan.space@gmail.com
+ *
+ *  Copyright (c) 2026 Felix Yuan
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * This part is slab allocated orbit models
+ *
+ */
+
+#pragma once
+#include "orbitmodel.h"
+#include <utility>
+
+namespace oat
+{
+    /**
+     * Factory placing orbit models and their orbit data caches side by side in large slabs,
+     * so a catalog of tens of thousands of objects is a handful of allocations instead of two
+     * per object. Everything is released at once by clear() or the destructor.
+     *
+     *     OrbitModelArena arena;
+     *     OrbitModel_SGP4* model = arena.create<OrbitModel_SGP4>(tle1, tle2, beginJD, endJD, step);
+     *
+     * create<T>(args...) constructs T(MemoryArena*, args...), so T needs a constructor taking the
+     * arena of its cache first. Models must not be deleted by the caller. create() and clear() are
+     * not thread safe; the models may grow their caches concurrently once created (see MemoryArena).
+     */
+    class OATCORE_API OrbitModelArena
+    {
+    public:
+        /// @brief Init OrbitModelArena
+        /// @param slabSize bytes of one slab
+        explicit OrbitModelArena(size_t slabSize = 4 << 20);
+        ~OrbitModelArena();
+
+        OrbitModelArena(const OrbitModelArena&) = delete;
+        OrbitModelArena& operator = (const OrbitModelArena&) = delete;
+
+        /// @brief Construct a model of type T in the arena
+        /// @param args constructor arguments following the arena
+        /// @return the model, owned by the arena
+        template <class T, class... Args>
+        T* create(Args&&... args)
+        {
+            void* p = m_memory.allocate(sizeof(T), alignof(T));
+            T* model = new (p) T(&m_memory, std::forward<Args>(args)...);
+            m_models.push_back(model);
+            return model;
+        }
+
+        /// @brief Destroy every model and release every slab
+        void clear();
+
+        //Get model number
+        size_t getModelNum() const {return m_models.size();};
+        //Get arena memory, e.g. for its reserved size
+        const MemoryArena& getMemory() const {return m_memory;};
+
+    private:
+        MemoryArena m_memory;
+        // destroyed through the virtual destructor, newest first
+        std::vector<OrbitModel*> m_models;
+    };
+}
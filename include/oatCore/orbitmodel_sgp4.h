@@ -23,18 +23,25 @@
  */
 
 #pragma once
-//增加导出宏
-#ifdef oatCore_EXPORTS
-#define OATCORE_API __declspec(dllexport)
-#else
-#define OATCORE_API __declspec(dllimport)
-#endif
 #include "orbitmodel.h"
+#include "sgp4/SGP4.h"
+#include <memory>
 namespace oat
 {
     class OATCORE_API OrbitModel_SGP4 : public OrbitModel
     {
     public:
+        struct CacheStats {
+            // queries answered from the cache
+            unsigned long long hits;
+            // queries outside of the cache answered by sgp4 directly
+            unsigned long long fallbacks;
+            // samples added to the cache by extension
+            unsigned long long extendedSamples;
+            // fallbacks sgp4 failed on (e.g. past decay), answered with a zero state
+            unsigned long long failures;
+        };
+
         /// @brief Init OrbitModel_SGP4
         /// @param cTleLine1st The first row of TLE data
         /// @param cTleLine2nd The Sencond row of TLE data
@@ -43,12 +50,22 @@ namespace oat
         /// @param dDeltaTime delta time 此值x1440为分钟
         OrbitModel_SGP4(const char *cTleLine1st, const char *cTleLine2nd, double dBeginTIme, double dEndTime, 
             double dDeltaTime, char opsmode = 'a', char typerun = 'c', char typeinput = 'e');
+        /// @brief Init OrbitModel_SGP4 with its orbit data cache in arena, used by OrbitModelArena
+        /// @param arena memory of the orbit data cache, NULL for the heap; must outlive the model
+        OrbitModel_SGP4(MemoryArena* arena, const char *cTleLine1st, const char *cTleLine2nd, double dBeginTIme, double dEndTime,
+            double dDeltaTime, char opsmode = 'a', char typerun = 'c', char typeinput = 'e');
         ~OrbitModel_SGP4();
+
+        OrbitModel_SGP4(const OrbitModel_SGP4&) = default;
+        OrbitModel_SGP4(OrbitModel_SGP4&&) noexcept = default;
+        OrbitModel_SGP4& operator = (const OrbitModel_SGP4&) = default;
+        OrbitModel_SGP4& operator = (OrbitModel_SGP4&&) noexcept = default;
         
         /**
 		* @brief Calculate the world coordinate position of entity at current JD time.
         *        The standard unit of Vec3 depends on the situation, and the celestial body is in kilometers <TODO To be determined>
         * @param jd [in] time , Time is Julian Day (in days <TODO To be determined > )
+        *        Outside of the cache the cache is extended (see setCacheExtension) or sgp4 is run directly.
         * @return position at current JD time; 三个分量的单位位千米
         * 位置数据表示卫星相对于地心的三维坐标。例如，6054.819833 -2700.602360 1496.441942 表示在三个空间坐标轴上（通常是地心惯性坐标系，即ECI），
         * 卫星位于地心东方6054.819833千米，北方-2700.602360千米，垂直方向1496.441942千米的位置。
@@ -58,6 +75,7 @@ namespace oat
 		* @brief Calculate the velocity vector of entity at current JD time.
         *        <TODO To be determined unit>
         * @param jd [in] time , Time is Julian Day (in days <TODO To be determined > )
+        *        Outside of the cache the cache is extended (see setCacheExtension) or sgp4 is run directly.
         * @return velocity at current JD time; 这个三分量的单位为千米/每秒
         * 速度数据表示卫星在这三个坐标轴上的瞬时速度。例如，3.181021 3.915930 -5.765891 表示卫星在地心惯性坐标系中，
         * 沿东方轴的速度为3.181021千米/秒，沿北方轴的速度为3.915930千米/秒，垂直向下方向的速度为-5.765891千米/秒。
@@ -70,7 +88,101 @@ namespace oat
         * @return quatertion at current JD time;
         */
         Quat quatAtJD(double jd);
+
+        /**
+		* @brief Position and velocity at jd with a single cache lookup, non virtual.
+        */
+        void stateAtJD(double jd, Vec3& position, Vec3& velocity);
+
+        using OrbitModel::positionsAtJD;
+        using OrbitModel::velocitiesAtJD;
+
+        /**
+		* @brief Interpolate positions for a batch of JD times from the cache.
+        *        Interval lookup is O(1) on the cache step grid; out of range times are handled
+        *        like positionAtJD.
+        */
+        void positionsAtJD(const double* jd, size_t n, double* x, double* y, double* z, size_t stride);
+
+        /**
+		* @brief Interpolate velocities for a batch of JD times from the cache, see positionsAtJD.
+        */
+        void velocitiesAtJD(const double* jd, size_t n, double* x, double* y, double* z, size_t stride);
+
+        /**
+		* @brief Run sgp4 directly at a set of JD times with the elements kept from construction.
+        *        Thread safe, each call works on its own copy of the elsetrec.
+        * @param jd [in] time array, Julian Day
+        * @param n [in] number of times
+        * @param out [out] n states, position in km, velocity in km/s (TEME)
+        * @return false if sgp4 reported an error at any of the times (e.g. decayed orbit)
+        */
+        bool propagate(const double* jd, size_t n, OrbitData* out) const;
+
+        /**
+		* @brief propagate at two part Julian dates, tsince is taken from the day and fraction parts
+        *        separately so it keeps full precision far from the epoch. out[i].jd is rounded.
+        * @return false if sgp4 reported an error at any of the times
+        */
+        bool propagate(const JulianDate* jd, size_t n, OrbitData* out) const;
+
+        /// @brief sgp4 tsince of n dates | unit: minutes from the element epoch
+        void tsinceAtJD(const JulianDate* jd, size_t n, double* tsince) const {minutesSince(getEpoch(), jd, n, tsince);};
+
+        //Get element set epoch
+        JulianDate getEpoch() const {return JulianDate(m_satrec.jdsatepoch, m_satrec.jdsatepochF);};
+
+        /// @brief Let out of range queries grow the cache toward the query time
+        ///        Extension reallocates the cache: OrbitDataViews and references to the orbit data
+        ///        taken before are invalidated by any query that extends it. Growing backward inserts
+        ///        in front of the cache and moves all of it (O(cache size) per extension), so give
+        ///        clocks running backward a wide enough initial span.
+        /// @param dMaxExtendTime queries at most this far (JD days) outside of the cache extend it,
+        ///        farther ones run sgp4 directly without caching; 0 disables extension (default)
+        void setCacheExtension(double dMaxExtendTime);
+
+        //Get orbit data cache, the shared block when EphemerisCache sharing is on
+        const OrbitDataVector& getOrbitCache() const {return cache();};
+        //Get whether the orbit data is a block shared with identical models
+        bool getShared() const {return (bool)m_sharedCache;};
+
+        //Get perigee radius from the mean elements | unit: km
+        double getPerigeeRadius() const {return m_perigeeRadius;};
+        //Get apogee radius from the mean elements | unit: km
+        double getApogeeRadius() const {return m_apogeeRadius;};
+
+        //Get cache hit / fallback statistics
+        const CacheStats& getCacheStats() const {return m_cacheStats;};
+        //Reset cache statistics
+        void resetCacheStats();
     private:
+        // orbit data in use, own or shared
+        const OrbitDataVector& cache() const {return m_sharedCache ? *m_sharedCache : orbitData;};
+        void batchAtJD(const double* jd, size_t n, Vec3 OrbitData::* member,
+                       double* x, double* y, double* z, size_t stride);
+        bool inCache(double jd) const;
+        // cache interval [i, i + 1] holding jd and the interpolation factor, jd must be in cache
+        void locate(double jd, size_t& i, double& factor) const;
+        // grow the cache on its step grid until it covers jd, false if jd is too far
+        bool extendCache(double jd);
+        // sgp4 at jd without touching the cache, a zero state if sgp4 fails
+        OrbitData directState(double jd);
+        // widen the bounding radius to enclose cached samples, short periodic terms reach past the mean apogee
+        void growBoundingRadius(const OrbitData* data, size_t n);
+
+        // initialized sgp4 elements
+        elsetrec m_satrec;
+        // cache step, JD days
+        double m_deltaTime;
+        // max distance outside of the cache that still extends it, JD days
+        double m_maxExtendTime;
+        // mean perigee / apogee radius, km
+        double m_perigeeRadius;
+        double m_apogeeRadius;
+        CacheStats m_cacheStats;
+        // immutable block of EphemerisCache used instead of orbitData, detached on cache extension
+        std::shared_ptr<const OrbitDataVector> m_sharedCache;
+
         // a or i 
         // 操作模式
         // a : best understanding of how afspc code works
@@ -104,4 +216,14 @@ namespace oat
         //gravconsttype  whichconst;
 
     };
+
+    // one cache lookup for position and velocity
+    template <>
+    struct ModelKernel<OrbitModel_SGP4>
+    {
+        static void evaluate(OrbitModel_SGP4* model, double jd, Vec3& position, Vec3& velocity)
+        {
+            model->stateAtJD(jd, position, velocity);
+        }
+    };
 }
@@ -0,0 +1,100 @@
+/*
+ * @file orbitpolyline_lod.h
+ *
+ * Created on Mon Oct 19 2026
+ * Created by Felix Yuan
+ * Email: FelixYuan.space@gmail.com
+ *
+ *  Copyright (c) 2026 Felix Yuan
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the 
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3 
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without 
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program. 
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * This part is multi resolution orbit polylines with a sliding time window
+ *  
+ */
+
+#pragma once
+#include "orbitmodel.h"
+
+namespace oat
+{
+    /**
+     * LOD pyramid of orbit polylines built once from an OrbitModel cache.
+     *
+     * Level 0 holds every cache sample, level k every 2^k-th one (the last sample is always kept).
+     * Each level records its largest chord error against the cache, so selectLevel() can pick the
+     * coarsest level that stays under a screen space tolerance.
+     *
+     * update() slides a [curJD - trail, curJD + lead] window over a level and reports only the
+     * vertices that scrolled in or out, so a renderer keeping the window in a ring buffer uploads
+     * the new vertices instead of regenerating the track every frame.
+     */
+    class OATCORE_API OrbitPolylineLOD
+    {
+    public:
+        struct WindowDelta {
+            // level of the window
+            int level;
+            // level or position jumped, the whole window [first, last) has to be uploaded again
+            bool bReset;
+            // window after the update, vertex index range of the level
+            size_t first;
+            size_t last;
+            // vertices dropped from the start / end of the window
+            size_t retiredFront;
+            size_t retiredBack;
+            // vertices added at the start ([first, first + appendedFront)) / end ([last - appendedBack, last))
+            size_t appendedFront;
+            size_t appendedBack;
+        };
+
+        /// @brief Build the pyramid from the cache of model (getOrbitCache)
+        /// @param model source model
+        /// @param levelNum number of levels, clamped so the coarsest level keeps 2 vertices
+        OrbitPolylineLOD(const OrbitModel& model, int levelNum = 8);
+
+        /// @brief Rebuild from a cache, e.g. after the model extended it
+        void build(const OrbitDataView& orbitData, int levelNum);
+
+        //Get level number
+        int getLevelNum() const {return (int)m_levels.size();};
+        //Get vertices of level, sim unit
+        const std::vector<Vec3>& getVertices(int level) const {return m_levels[level].vertices;};
+        //Get JD of every vertex of level
+        const std::vector<double>& getTimes(int level) const {return m_levels[level].jd;};
+        //Get largest chord error of level, sim unit
+        double getMaxError(int level) const {return m_levels[level].maxError;};
+
+        /// @brief Coarsest level whose chord error stays under the tolerance
+        int selectLevel(const SampleTolerance& tolerance) const;
+
+        /// @brief Slide the window to [curJD - trailTime, curJD + leadTime] on level
+        /// @param curJD current JD, the exact head position is OrbitModel::positionAtJD(curJD)
+        /// @param trailTime trailing span, JD days
+        /// @param leadTime leading span, JD days
+        /// @param level level to draw, usually selectLevel()
+        /// @return changes against the previous window
+        const WindowDelta& update(double curJD, double trailTime, double leadTime, int level);
+
+        //Get current window
+        const WindowDelta& getWindow() const {return m_window;};
+    private:
+        struct Level {
+            std::vector<Vec3> vertices;
+            std::vector<double> jd;
+            double maxError;
+        };
+
+        std::vector<Level> m_levels;
+        WindowDelta m_window;
+    };
+}
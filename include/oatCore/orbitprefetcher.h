@@ -0,0 +1,137 @@
+/*
+ * @file orbitprefetcher.h
+ *
+ * Created on Mon Oct 19 2026
+ * Created by Felix Yuan
+ * Email: FelixYuan.space@gmail.com
+ *
+ *  Copyright (c) 2026 Felix Yuan
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the 
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3 
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without 
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program. 
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * This part is background prefetch of ephemeris blocks for timeline playback
+ *  
+ */
+
+#pragma once
+#include "orbitmodel.h"
+#include "oat_thread_pool.h"
+#include <atomic>
+#include <memory>
+
+namespace oat
+{
+    /**
+     * Prefetches ephemeris blocks ahead of the simulation clock.
+     *
+     * The time axis is cut into blocks of blockSize steps. update() is called once per frame
+     * with the clock and the playback rate, and requests every block the clock will reach within
+     * the lead time (in the playback direction) from the worker threads. A worker evaluates the
+     * block with OrbitModel::propagate and publishes it with an atomic pointer swap, so the
+     * queries never take a lock. While a block is not ready the queries fall back to the model.
+     * A block the model fails to propagate (e.g. past decay) is only dropped, it is requested again
+     * once its slot has served another block, and the blocks around it keep being prefetched.
+     *
+     * attach(), update() and the queries must be called from the same (render) thread.
+     */
+    class OATCORE_API OrbitPrefetcher
+    {
+    public:
+        struct Stats {
+            // queries answered from a published block
+            unsigned long long hits;
+            // queries that had to fall back to the model
+            unsigned long long misses;
+            // blocks finished by the workers
+            unsigned long long blocksPublished;
+            // blocks dropped because the model failed to propagate them
+            unsigned long long blocksFailed;
+        };
+
+        /// @brief Init OrbitPrefetcher
+        /// @param dDeltaTime sample step inside a block, JD days
+        /// @param blockSize step number of a block
+        /// @param blockNum block slots kept per model around the clock
+        /// @param threadNum worker thread number
+        OrbitPrefetcher(double dDeltaTime, int blockSize = 256, int blockNum = 8, unsigned int threadNum = 1);
+        ~OrbitPrefetcher();
+
+        /// @brief Attach a model, it is not owned and must outlive the prefetcher
+        /// @param model model to prefetch, has to support OrbitModel::propagate
+        /// @return handle used by the queries
+        int attach(OrbitModel* model);
+
+        /// @brief Wall clock time to look ahead of the clock, default 2 seconds
+        /// @param dSeconds lead time in seconds
+        void setLeadTime(double dSeconds) {m_leadTime = dSeconds;};
+
+        /// @brief Release retired blocks and request the blocks needed next
+        /// @param curJD current simulation JD
+        /// @param rate playback rate in JD days per wall clock second, the sign is the direction
+        void update(double curJD, double rate);
+
+        /// @brief Interpolate the state from the published blocks
+        /// @return false if the block of jd is not published yet
+        bool stateAtJD(int handle, double jd, Vec3& position, Vec3& velocity);
+
+        /// @brief Position from the published blocks, falls back to OrbitModel::positionAtJD
+        Vec3 positionAtJD(int handle, double jd);
+
+        /// @brief Velocity from the published blocks, falls back to OrbitModel::velocityAtJD
+        Vec3 velocityAtJD(int handle, double jd);
+
+        //Get hit/miss statistics
+        Stats getStats() const;
+    private:
+        struct Block {
+            long long index;
+            double beginJD;
+            std::vector<OrbitData> data;
+        };
+        struct Slot {
+            // published block, read lock-free by the render thread
+            std::atomic<Block*> block;
+            // block index last requested for this slot
+            std::atomic<long long> requested;
+        };
+        struct Entry {
+            OrbitModel* model;
+            std::unique_ptr<Slot[]> slots;
+        };
+
+        OrbitPrefetcher(const OrbitPrefetcher&);
+        OrbitPrefetcher& operator=(const OrbitPrefetcher&);
+
+        long long blockIndex(double jd) const;
+        const Block* findBlock(int handle, double jd) const;
+        void request(Entry* entry, long long index);
+        void computeBlock(Entry* entry, long long index);
+
+        double m_deltaTime;
+        int m_blockSize;
+        int m_blockNum;
+        double m_leadTime;
+
+        std::vector<std::unique_ptr<Entry> > m_entries;
+
+        // blocks replaced by the workers, freed by update() on the render thread
+        std::mutex m_retiredMutex;
+        std::vector<Block*> m_retired;
+
+        unsigned long long m_hits;
+        unsigned long long m_misses;
+        std::atomic<unsigned long long> m_published;
+        std::atomic<unsigned long long> m_failed;
+
+        std::unique_ptr<ThreadPool> m_pool;
+    };
+}
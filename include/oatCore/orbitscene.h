@@ -0,0 +1,183 @@
+/*
+ * @file orbitscene.h
+ *
+ * Created on Mon Oct 19 2026
+ * Created by Felix Yuan
+ * Email: FelixYuan.space@gmail.com
+ *
+ *  Copyright (c) 2026 Felix Yuan
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the 
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3 
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without 
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program. 
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * This part is frame evaluation of many orbit models at one JD
+ *  
+ */
+
+#pragma once
+#include "orbitmodel.h"
+#include "oat_thread_pool.h"
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <typeindex>
+#include <typeinfo>
+
+namespace oat
+{
+    /**
+     * Evaluates every model of a scene at one JD on a thread pool into SoA buffers.
+     *
+     * Two frame buffers are kept: while the renderer reads the front one (frame N), beginFrame()
+     * fills the back one (frame N + 1) in the background, and endFrame() waits for it and swaps.
+     *
+     *     scene.beginFrame(jd);
+     *     for (;;) {
+     *         const OrbitScene::Frame& frame = scene.endFrame();
+     *         scene.beginFrame(nextJD);
+     *         render(frame);
+     *     }
+     *
+     * Models are grouped by concrete type. addModel(T*) puts a model into the group of T, which is
+     * evaluated by a ModelKernel<T> without any virtual call per object; addModel(OrbitModel*) and
+     * models whose dynamic type is not T go to a generic group that calls through the vtable.
+     *
+     * Every model is evaluated by exactly one worker per frame. Models must not be added and the
+     * models must not be used elsewhere while a frame is in flight.
+     */
+    class OATCORE_API OrbitScene
+    {
+    public:
+        struct Frame {
+            // JD of the frame
+            double jd;
+            // position of model i, unit of OrbitModel::positionAtJD
+            std::vector<double> x, y, z;
+            // velocity of model i, unit of OrbitModel::velocityAtJD
+            std::vector<double> vx, vy, vz;
+            // wall time spent evaluating the frame | unit: ms
+            double evalTime;
+        };
+
+        /// @brief Init OrbitScene
+        /// @param threadNum worker thread number, 0 use all hardware threads
+        explicit OrbitScene(unsigned int threadNum = 0);
+        ~OrbitScene();
+
+        /// @brief Add a model evaluated through its virtual interface, it is not owned and must outlive the scene
+        /// @return index of the model in the frame buffers, (size_t)-1 if model is NULL
+        size_t addModel(OrbitModel* model);
+
+        /// @brief Add a model to the devirtualized group of its concrete type T
+        /// @return index of the model in the frame buffers, (size_t)-1 if model is NULL
+        template <class T>
+        size_t addModel(T* model)
+        {
+            if (model == NULL)
+            {
+                return (size_t)-1;
+            }
+            // a more derived object would lose its overrides to the qualified calls
+            if (typeid(*model) != typeid(T))
+            {
+                return addModel(static_cast<OrbitModel*>(model));
+            }
+            ModelGroup*& group = m_groupOfType[std::type_index(typeid(T))];
+            if (group == NULL)
+            {
+                m_groups.push_back(std::unique_ptr<ModelGroup>(new TypedModelGroup<T>()));
+                group = m_groups.back().get();
+            }
+            static_cast<TypedModelGroup<T>*>(group)->models.push_back(model);
+            group->slots.push_back(m_modelNum);
+            return m_modelNum++;
+        }
+
+        //Get model number
+        size_t getModelNum() const {return m_modelNum;};
+
+        /// @brief Start evaluating all models at jd into the back buffer, returns at once
+        void beginFrame(double jd);
+
+        /// @brief Wait for the frame started by beginFrame() and make it the front buffer
+        /// @return front buffer, valid until the next endFrame()
+        const Frame& endFrame();
+
+        /// @brief beginFrame() + endFrame()
+        const Frame& evaluate(double jd);
+
+        //Get front buffer
+        const Frame& getFrontFrame() const {return m_frames[m_front];};
+        //Get evaluation time of the front frame, ms
+        double getLastEvalTime() const {return m_frames[m_front].evalTime;};
+    private:
+        // models of one type, member i is written to frame index slots[i]
+        struct ModelGroup {
+            std::vector<size_t> slots;
+            virtual ~ModelGroup() {}
+            // evaluate members [begin, end) into frame, one virtual call per chunk
+            virtual void evaluate(size_t begin, size_t end, double jd, Frame& frame) = 0;
+        };
+
+        template <class T>
+        struct TypedModelGroup : public ModelGroup {
+            std::vector<T*> models;
+            void evaluate(size_t begin, size_t end, double jd, Frame& frame)
+            {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    Vec3 p, v;
+                    ModelKernel<T>::evaluate(models[i], jd, p, v);
+                    const size_t slot = slots[i];
+                    frame.x[slot] = p.x();
+                    frame.y[slot] = p.y();
+                    frame.z[slot] = p.z();
+                    frame.vx[slot] = v.x();
+                    frame.vy[slot] = v.y();
+                    frame.vz[slot] = v.z();
+                }
+            }
+        };
+
+        // models added through the virtual interface
+        struct VirtualModelGroup : public ModelGroup {
+            std::vector<OrbitModel*> models;
+            void evaluate(size_t begin, size_t end, double jd, Frame& frame);
+        };
+
+        // members [begin, end) of one group, the unit of work of a worker
+        struct Chunk {
+            ModelGroup* group;
+            size_t begin;
+            size_t end;
+        };
+
+        OrbitScene(const OrbitScene&);
+        OrbitScene& operator=(const OrbitScene&);
+
+        void resizeFrame(Frame& frame) const;
+
+        std::vector<std::unique_ptr<ModelGroup> > m_groups;
+        std::map<std::type_index, ModelGroup*> m_groupOfType;
+        VirtualModelGroup* m_virtualGroup;
+        size_t m_modelNum;
+        // chunks of the frame in flight, refilled by beginFrame() without reallocating
+        std::vector<Chunk> m_chunks;
+
+        Frame m_frames[2];
+        int m_front;
+        bool m_inFlight;
+        std::atomic<int> m_pendingChunks;
+        std::chrono::steady_clock::time_point m_beginTime;
+        std::unique_ptr<ThreadPool> m_pool;
+    };
+}
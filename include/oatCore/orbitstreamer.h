@@ -0,0 +1,125 @@
+/*
+ * @file orbitstreamer.h
+ *
+ * Created on Mon Oct 19 2026
+ * Created by Felix Yuan
+ * Email: FelixYuan.space@gmail.com
+ *
+ *  Copyright (c) 2026 Felix Yuan
+ *
+ * This program is free software: you can redistribute it and/or modify it under the terms of the
+ * GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ *
+ * This part is real time streaming of future states into ring buffers
+ *
+ */
+
+#pragma once
+#include "orbitmodel.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace oat
+{
+    /**
+     * Streams the states of a live clock, which only moves forward, into a fixed ring per model.
+     *
+     * Sample k of every ring is the state at k * dDeltaTime. A background producer thread keeps each
+     * ring filled with the capacity samples following the clock using OrbitModel::propagate. The
+     * render thread is the only consumer: update() moves the clock and wakes the producer, queries
+     * interpolate between two ring samples. Each ring is a single producer / single consumer queue
+     * of two atomic indices, so neither side ever takes a lock and memory stays constant.
+     *
+     * Queries behind the clock or beyond the filled samples fall back to the model.
+     * attach() all models before the first update(); attach(), update() and the queries must be
+     * called from the same (render) thread.
+     */
+    class OATCORE_API OrbitStreamer
+    {
+    public:
+        struct Stats {
+            // queries answered from a ring
+            unsigned long long hits;
+            // queries that had to fall back to the model
+            unsigned long long misses;
+            // samples computed by the producer
+            unsigned long long produced;
+        };
+
+        /// @brief Init OrbitStreamer and its producer thread
+        /// @param dDeltaTime sample step, JD days
+        /// @param capacity ring size per model, rounded up to a power of two
+        OrbitStreamer(double dDeltaTime, size_t capacity = 256);
+        ~OrbitStreamer();
+
+        /// @brief Attach a model, it is not owned and must outlive the streamer
+        /// @param model model to stream, has to support OrbitModel::propagate
+        /// @return handle used by the queries, -1 after the first update()
+        int attach(OrbitModel* model);
+
+        /// @brief Advance the clock: release the samples behind it and wake the producer
+        /// @param curJD current simulation JD, never decreasing
+        void update(double curJD);
+
+        /// @brief Interpolate the state from the ring
+        /// @return false if jd is behind the clock or not produced yet
+        bool stateAtJD(int handle, double jd, Vec3& position, Vec3& velocity);
+
+        /// @brief Position from the ring, falls back to OrbitModel::positionAtJD
+        Vec3 positionAtJD(int handle, double jd);
+
+        /// @brief Velocity from the ring, falls back to OrbitModel::velocityAtJD
+        Vec3 velocityAtJD(int handle, double jd);
+
+        //Get hit/miss statistics
+        Stats getStats() const;
+    private:
+        struct Ring {
+            OrbitModel* model;
+            std::unique_ptr<OrbitData[]> data;
+            // next sample index the producer writes, published with release
+            std::atomic<long long> head;
+            // oldest sample index the consumer still reads, -1 before the first update
+            std::atomic<long long> tail;
+            // model can not propagate, stop producing
+            std::atomic<bool> failed;
+        };
+
+        OrbitStreamer(const OrbitStreamer&);
+        OrbitStreamer& operator=(const OrbitStreamer&);
+
+        void producerLoop();
+        // produce up to one batch into ring, return the sample number written
+        size_t fill(Ring& ring);
+        // move the consumer side of ring up to jd, return the sample before jd or -1 if it is not readable
+        long long advance(Ring& ring, double jd);
+
+        double m_deltaTime;
+        size_t m_capacity;
+        size_t m_mask;
+        bool m_bStarted;
+
+        std::vector<std::unique_ptr<Ring> > m_rings;
+
+        unsigned long long m_hits;
+        unsigned long long m_misses;
+        std::atomic<unsigned long long> m_produced;
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        bool m_bWake;
+        std::atomic<bool> m_stop;
+        std::thread m_producer;
+    };
+}
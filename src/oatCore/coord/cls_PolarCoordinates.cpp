@@ -1,4 +1,5 @@
 #include "cls_PolarCoordinates.h"
+#include "coord_polar.h"
 #include <math.h>
 
 cls_PolarCoordinates::cls_PolarCoordinates(  )
@@ -37,3 +38,11 @@ cls_PolarCoordinates cls_PolarCoordinates::Convert( struct_RelativesInPolarCoord
 
 	return cls_PolarCoordinates( _double_RadiusFinal , _double_PhiFinal , _double_ThetaFinal );
 }
+
+void cls_PolarCoordinates::Convert( struct_RelativesInPolarCoordinates in_struct_Observer , size_t in_size_Num ,
+	const double* in_double_Radius , const double* in_double_Phi , const double* in_double_Theta ,
+	double* out_double_Radius , double* out_double_Phi , double* out_double_Theta )
+{
+	oatCoord::PolarObserver _observer( in_struct_Observer.double_Radius , in_struct_Observer.double_Phi , in_struct_Observer.double_Theta );
+	_observer.convert( in_size_Num , in_double_Radius , in_double_Phi , in_double_Theta , out_double_Radius , out_double_Phi , out_double_Theta );
+}
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 
 struct struct_RelativesInPolarCoordinates
 {
@@ -26,4 +27,8 @@ class cls_PolarCoordinates
 	/*function members*/
 	public:
 	cls_PolarCoordinates Convert( struct_RelativesInPolarCoordinates in_struct_RelativesInPolarCoordinates );
+	/* many bodies relative to one observer, SoA arrays; atan2 based, see oatCoord::PolarObserver */
+	static void Convert( struct_RelativesInPolarCoordinates in_struct_Observer , size_t in_size_Num ,
+		const double* in_double_Radius , const double* in_double_Phi , const double* in_double_Theta ,
+		double* out_double_Radius , double* out_double_Phi , double* out_double_Theta );
 };
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "coord_footprint.h"
+#include "coord_transform.h"
+#include "oat_math_const.h"
+#include <cmath>
+
+namespace oatCoord {
+    FootprintGenerator::FootprintGenerator(size_t vertexNum, double minElevation)
+        :m_minElevation(minElevation)
+        , m_cosElevation(cos(minElevation * PI / 180.0))
+    {
+        vertexNum = vertexNum > 3 ? vertexNum : 3;
+        m_cos.resize(vertexNum);
+        m_sin.resize(vertexNum);
+        m_x.resize(vertexNum);
+        m_y.resize(vertexNum);
+        m_z.resize(vertexNum);
+        for (size_t k = 0; k < vertexNum; ++k)
+        {
+            double theta = 2.0 * PI * (double)k / (double)vertexNum;
+            m_cos[k] = cos(theta);
+            m_sin[k] = sin(theta);
+        }
+    }
+
+    void FootprintGenerator::generate(size_t n, const GeoCoord* subPoints, Footprints& footprints)
+    {
+        const size_t m = m_cos.size();
+        const double toRad = PI / 180.0;
+        const double toDeg = 180.0 / PI;
+        const double elevation = m_minElevation * toRad;
+        footprints.vertexNum = m;
+        footprints.lon.resize(n * m);
+        footprints.lat.resize(n * m);
+        footprints.radius.resize(n);
+        footprints.pole.resize(n);
+
+        const double* tc = &m_cos[0];
+        const double* ts = &m_sin[0];
+        double* x = &m_x[0];
+        double* y = &m_y[0];
+        double* z = &m_z[0];
+        for (size_t i = 0; i < n; ++i)
+        {
+            const GeoCoord& sub = subPoints[i];
+            double altitude = sub.Altitude > 0.0 ? sub.Altitude : 0.0;
+            // central angle where the satellite is seen at the minimum elevation
+            double lambda = acos(WGS84_A * m_cosElevation / (WGS84_A + altitude)) - elevation;
+            lambda = lambda > 0.0 ? lambda : 0.0;
+            footprints.radius[i] = lambda * toDeg;
+            footprints.pole[i] = fabs(sub.Latitude) * toRad + lambda > 0.5 * PI ? 1 : 0;
+
+            double sinLat = sin(sub.Latitude * toRad);
+            double cosLat = cos(sub.Latitude * toRad);
+            double sinLon = sin(sub.Lontitude * toRad);
+            double cosLon = cos(sub.Lontitude * toRad);
+            double cosLambda = cos(lambda);
+            double sinLambda = sin(lambda);
+            // up * cos(lambda) and north / east scaled by sin(lambda)
+            const double cx = cosLat * cosLon * cosLambda, cy = cosLat * sinLon * cosLambda, cz = sinLat * cosLambda;
+            const double nx = -sinLat * cosLon * sinLambda, ny = -sinLat * sinLon * sinLambda, nz = cosLat * sinLambda;
+            const double ex = -sinLon * sinLambda, ey = cosLon * sinLambda;
+
+            for (size_t k = 0; k < m; ++k)
+            {
+                x[k] = cx + tc[k] * nx + ts[k] * ex;
+                y[k] = cy + tc[k] * ny + ts[k] * ey;
+                z[k] = cz + tc[k] * nz;
+            }
+
+            double* lon = &footprints.lon[i * m];
+            double* lat = &footprints.lat[i * m];
+            const double center = sub.Lontitude;
+            for (size_t k = 0; k < m; ++k)
+            {
+                double zk = z[k] > 1.0 ? 1.0 : (z[k] < -1.0 ? -1.0 : z[k]);
+                lat[k] = asin(zk) * toDeg;
+                // relative to the center, continuous as long as the pole is outside
+                double dlon = atan2(y[k], x[k]) * toDeg - center;
+                dlon -= 360.0 * floor((dlon + 180.0) / 360.0);
+                lon[k] = center + dlon;
+            }
+        }
+    }
+}
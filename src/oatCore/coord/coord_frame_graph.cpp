@@ -0,0 +1,297 @@
+#include "coord_frame_graph.h"
+#include "coord_transform.h"
+#include "oat_math_const.h"
+#include <cmath>
+
+namespace oatCoord {
+    static const double ARCSEC_TO_RAD = PI / (180.0 * 3600.0);
+    static const double DEG_TO_RAD = PI / 180.0;
+    static const double AU = 149597870700.0;
+
+    // c = a * b, 3x3
+    static void mult3(const double a[3][3], const double b[3][3], double c[3][3])
+    {
+        double r[3][3];
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                r[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j];
+            }
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                c[i][j] = r[i][j];
+            }
+        }
+    }
+
+    // passive (frame) rotations about x, y, z
+    static void rot1(double a, double m[3][3])
+    {
+        double c = cos(a), s = sin(a);
+        m[0][0] = 1.0; m[0][1] = 0.0; m[0][2] = 0.0;
+        m[1][0] = 0.0; m[1][1] = c;   m[1][2] = s;
+        m[2][0] = 0.0; m[2][1] = -s;  m[2][2] = c;
+    }
+
+    static void rot2(double a, double m[3][3])
+    {
+        double c = cos(a), s = sin(a);
+        m[0][0] = c;   m[0][1] = 0.0; m[0][2] = -s;
+        m[1][0] = 0.0; m[1][1] = 1.0; m[1][2] = 0.0;
+        m[2][0] = s;   m[2][1] = 0.0; m[2][2] = c;
+    }
+
+    static void rot3(double a, double m[3][3])
+    {
+        double c = cos(a), s = sin(a);
+        m[0][0] = c;   m[0][1] = s;   m[0][2] = 0.0;
+        m[1][0] = -s;  m[1][1] = c;   m[1][2] = 0.0;
+        m[2][0] = 0.0; m[2][1] = 0.0; m[2][2] = 1.0;
+    }
+
+    // row vector matrix of the column mapping p_parent = a * p_child + t
+    static oat::Matrix childToParent(const double a[3][3], const oat::Vec3& t)
+    {
+        return oat::Matrix(a[0][0], a[1][0], a[2][0], 0.0,
+                           a[0][1], a[1][1], a[2][1], 0.0,
+                           a[0][2], a[1][2], a[2][2], 0.0,
+                           t.x(), t.y(), t.z(), 1.0);
+    }
+
+    // column mapping p_teme = m * p_gcrf, IAU-76 precession, truncated IAU-80 nutation
+    static void gcrfToTeme(double jd, double m[3][3])
+    {
+        double t = (jd - 2451545.0) / 36525.0;
+        double t2 = t * t;
+        double t3 = t2 * t;
+
+        double zeta = (2306.2181 * t + 0.30188 * t2 + 0.017998 * t3) * ARCSEC_TO_RAD;
+        double theta = (2004.3109 * t - 0.42665 * t2 - 0.041833 * t3) * ARCSEC_TO_RAD;
+        double z = (2306.2181 * t + 1.09468 * t2 + 0.018203 * t3) * ARCSEC_TO_RAD;
+
+        // mean obliquity and the leading nutation terms (Meeus)
+        double epsMean = (84381.448 - 46.8150 * t - 0.00059 * t2 + 0.001813 * t3) * ARCSEC_TO_RAD;
+        double omega = (125.04452 - 1934.136261 * t) * DEG_TO_RAD;
+        double sunL = (280.4665 + 36000.7698 * t) * DEG_TO_RAD;
+        double moonL = (218.3165 + 481267.8813 * t) * DEG_TO_RAD;
+        double dPsi = (-17.20 * sin(omega) - 1.32 * sin(2.0 * sunL) - 0.23 * sin(2.0 * moonL) + 0.21 * sin(2.0 * omega)) * ARCSEC_TO_RAD;
+        double dEps = (9.20 * cos(omega) + 0.57 * cos(2.0 * sunL) + 0.10 * cos(2.0 * moonL) - 0.09 * cos(2.0 * omega)) * ARCSEC_TO_RAD;
+        // TEME differs from true of date by the equation of the equinoxes
+        double eqe = dPsi * cos(epsMean);
+
+        double a[3][3], b[3][3];
+        // precession P = R3(-z) R2(theta) R3(-zeta)
+        rot3(-zeta, m);
+        rot2(theta, a);
+        mult3(a, m, m);
+        rot3(-z, a);
+        mult3(a, m, m);
+        // nutation N = R1(-eps) R3(-dPsi) R1(epsMean)
+        rot1(epsMean, a);
+        mult3(a, m, m);
+        rot3(-dPsi, a);
+        mult3(a, m, m);
+        rot1(-(epsMean + dEps), a);
+        mult3(a, m, m);
+        // TEME = R3(eqe) TOD
+        rot3(eqe, b);
+        mult3(b, m, m);
+    }
+
+    // geocentric Sun in GCRF, Astronomical Almanac low precision series | unit: meter
+    static oat::Vec3 sunPosition(double jd)
+    {
+        double n = jd - 2451545.0;
+        double L = (280.460 + 0.9856474 * n) * DEG_TO_RAD;
+        double g = (357.528 + 0.9856003 * n) * DEG_TO_RAD;
+        // ecliptic longitude of date, brought back to the J2000 equinox by the general precession
+        double lambda = L + (1.915 * sin(g) + 0.020 * sin(2.0 * g)) * DEG_TO_RAD;
+        lambda -= 1.396971 * DEG_TO_RAD * n / 36525.0;
+        double r = (1.00014 - 0.01671 * cos(g) - 0.00014 * cos(2.0 * g)) * AU;
+        const double eps0 = 84381.448 * ARCSEC_TO_RAD;
+        return oat::Vec3(r * cos(lambda), r * cos(eps0) * sin(lambda), r * sin(eps0) * sin(lambda));
+    }
+
+    FrameGraph::FrameGraph()
+        :m_jd(0.0)
+        , m_xp(0.0)
+        , m_yp(0.0)
+        , m_buildNum(0)
+    {
+        invalidate();
+    }
+
+    void FrameGraph::invalidate()
+    {
+        for (int i = 0; i < FRAME_NUM; ++i)
+        {
+            m_bRootValid[i] = false;
+            for (int j = 0; j < FRAME_NUM; ++j)
+            {
+                m_bCompositeValid[i][j] = false;
+            }
+        }
+    }
+
+    void FrameGraph::setSite(const GeoCoord& site)
+    {
+        m_site = site;
+        invalidate();
+    }
+
+    void FrameGraph::setLvlhTarget(const oat::Vec3& position, const oat::Vec3& velocity)
+    {
+        m_targetPosition = position;
+        m_targetVelocity = velocity;
+        invalidate();
+    }
+
+    void FrameGraph::setPolarMotion(double xp, double yp)
+    {
+        m_xp = xp;
+        m_yp = yp;
+        invalidate();
+    }
+
+    oat::Matrix FrameGraph::toParent(Frame frame) const
+    {
+        double a[3][3];
+        switch (frame)
+        {
+        case FRAME_TEME:
+        {
+            // p_gcrf = m^T p_teme
+            double m[3][3];
+            gcrfToTeme(m_jd, m);
+            for (int i = 0; i < 3; ++i)
+            {
+                for (int j = 0; j < 3; ++j)
+                {
+                    a[i][j] = m[j][i];
+                }
+            }
+            return childToParent(a, oat::Vec3());
+        }
+        case FRAME_ITRF:
+        {
+            // p_itrf = polar R3(gmst) p_teme, invert by transposing
+            EarthOrientation orientation(m_jd, m_xp, m_yp);
+            double r[3][3], m[3][3];
+            rot3(orientation.gmst, r);
+            mult3(orientation.polar, r, m);
+            for (int i = 0; i < 3; ++i)
+            {
+                for (int j = 0; j < 3; ++j)
+                {
+                    a[i][j] = m[j][i];
+                }
+            }
+            return childToParent(a, oat::Vec3());
+        }
+        case FRAME_ENU:
+        {
+            ECEFCoord origin;
+            geodeticToEcef(1, &m_site, &origin);
+            double sinLat = sin(m_site.Latitude * DEG_TO_RAD);
+            double cosLat = cos(m_site.Latitude * DEG_TO_RAD);
+            double sinLon = sin(m_site.Lontitude * DEG_TO_RAD);
+            double cosLon = cos(m_site.Lontitude * DEG_TO_RAD);
+            // columns: north, up, east in ECEF
+            a[0][0] = -sinLat * cosLon; a[0][1] = cosLat * cosLon; a[0][2] = -sinLon;
+            a[1][0] = -sinLat * sinLon; a[1][1] = cosLat * sinLon; a[1][2] = cosLon;
+            a[2][0] = cosLat;           a[2][1] = sinLat;          a[2][2] = 0.0;
+            return childToParent(a, oat::Vec3(origin.x, origin.y, origin.z));
+        }
+        case FRAME_LVLH:
+        {
+            oat::Vec3 z = -m_targetPosition;
+            z.normalize();
+            oat::Vec3 y = m_targetVelocity ^ m_targetPosition;
+            y.normalize();
+            oat::Vec3 x = y ^ z;
+            // columns: x, y, z in TEME
+            for (int i = 0; i < 3; ++i)
+            {
+                a[i][0] = x[i];
+                a[i][1] = y[i];
+                a[i][2] = z[i];
+            }
+            return childToParent(a, m_targetPosition);
+        }
+        case FRAME_HELIOCENTRIC:
+        {
+            // p_ecliptic = R1(eps0) p_equator, the Earth is at minus the geocentric Sun
+            double m[3][3];
+            rot1(84381.448 * ARCSEC_TO_RAD, m);
+            for (int i = 0; i < 3; ++i)
+            {
+                for (int j = 0; j < 3; ++j)
+                {
+                    a[i][j] = m[j][i];
+                }
+            }
+            return childToParent(a, sunPosition(m_jd));
+        }
+        default:
+            return oat::Matrix::identity();
+        }
+    }
+
+    const oat::Matrix& FrameGraph::toRoot(Frame frame)
+    {
+        if (!m_bRootValid[frame])
+        {
+            static const Frame parents[FRAME_NUM] = {FRAME_GCRF, FRAME_GCRF, FRAME_TEME, FRAME_ITRF, FRAME_TEME, FRAME_GCRF};
+            if (frame == FRAME_GCRF)
+            {
+                m_toRoot[frame].makeIdentity();
+            }
+            else
+            {
+                // child first, then the parent chain
+                m_toRoot[frame].mult(toParent(frame), toRoot(parents[frame]));
+            }
+            m_bRootValid[frame] = true;
+        }
+        return m_toRoot[frame];
+    }
+
+    const oat::Matrix& FrameGraph::getTransform(Frame from, Frame to, double jd)
+    {
+        if (jd != m_jd)
+        {
+            m_jd = jd;
+            invalidate();
+        }
+        if (!m_bCompositeValid[from][to])
+        {
+            oat::Matrix rootToTarget;
+            rootToTarget.invert_4x3(toRoot(to));
+            m_composite[from][to].mult(toRoot(from), rootToTarget);
+            m_bCompositeValid[from][to] = true;
+            ++m_buildNum;
+        }
+        return m_composite[from][to];
+    }
+
+    void FrameGraph::transform(Frame from, Frame to, double jd, size_t n, const double* x, const double* y, const double* z,
+                               double* ox, double* oy, double* oz)
+    {
+        const oat::Matrix& m = getTransform(from, to, jd);
+        const double m00 = m(0, 0), m01 = m(0, 1), m02 = m(0, 2);
+        const double m10 = m(1, 0), m11 = m(1, 1), m12 = m(1, 2);
+        const double m20 = m(2, 0), m21 = m(2, 1), m22 = m(2, 2);
+        const double tx = m(3, 0), ty = m(3, 1), tz = m(3, 2);
+        for (size_t i = 0; i < n; ++i)
+        {
+            double px = x[i], py = y[i], pz = z[i];
+            ox[i] = px * m00 + py * m10 + pz * m20 + tx;
+            oy[i] = px * m01 + py * m11 + pz * m21 + ty;
+            oz[i] = px * m02 + py * m12 + pz * m22 + tz;
+        }
+    }
+}
@@ -0,0 +1,143 @@
+#include "coord_lookangle.h"
+#include "coord_transform.h"
+#include "oat_math_const.h"
+#include <cmath>
+
+namespace oatCoord {
+    LookAngleEngine::LookAngleEngine(size_t tileSize, size_t batchSize)
+        :m_tileSize(tileSize > 0 ? tileSize : 1)
+        , m_batchSize(batchSize > 0 ? batchSize : 1)
+        , m_east(m_tileSize)
+        , m_north(m_tileSize)
+        , m_up(m_tileSize)
+        , m_range(m_tileSize)
+        , m_rangeRate(m_tileSize)
+        , m_results(m_batchSize)
+        , m_resultNum(0)
+    {
+
+    }
+
+    size_t LookAngleEngine::addStation(const GeoCoord& site, double minElevation)
+    {
+        ECEFCoord position;
+        geodeticToEcef(1, &site, &position);
+        m_siteX.push_back(position.x);
+        m_siteY.push_back(position.y);
+        m_siteZ.push_back(position.z);
+
+        const double toRad = PI / 180.0;
+        double sinLat = sin(site.Latitude * toRad);
+        double cosLat = cos(site.Latitude * toRad);
+        double sinLon = sin(site.Lontitude * toRad);
+        double cosLon = cos(site.Lontitude * toRad);
+        m_eastX.push_back(-sinLon);
+        m_eastY.push_back(cosLon);
+        m_northX.push_back(-sinLat * cosLon);
+        m_northY.push_back(-sinLat * sinLon);
+        m_northZ.push_back(cosLat);
+        m_upX.push_back(cosLat * cosLon);
+        m_upY.push_back(cosLat * sinLon);
+        m_upZ.push_back(sinLat);
+        m_sinMask.push_back(sin(minElevation * toRad));
+        return m_siteX.size() - 1;
+    }
+
+    ENUCoord LookAngleEngine::toENU(size_t station, const ECEFCoord& position) const
+    {
+        double dx = position.x - m_siteX[station];
+        double dy = position.y - m_siteY[station];
+        double dz = position.z - m_siteZ[station];
+        double east = m_eastX[station] * dx + m_eastY[station] * dy;
+        double north = m_northX[station] * dx + m_northY[station] * dy + m_northZ[station] * dz;
+        double up = m_upX[station] * dx + m_upY[station] * dy + m_upZ[station] * dz;
+        return ENUCoord(north, up, east);
+    }
+
+    void LookAngleEngine::evaluate(size_t n, const double* x, const double* y, const double* z,
+                                   const double* vx, const double* vy, const double* vz,
+                                   const Sink& sink, bool bApplyMask)
+    {
+        const double toDeg = 180.0 / PI;
+        const bool bVelocity = vx != NULL && vy != NULL && vz != NULL;
+        double* east = &m_east[0];
+        double* north = &m_north[0];
+        double* up = &m_up[0];
+        double* range = &m_range[0];
+        double* rangeRate = &m_rangeRate[0];
+
+        m_resultNum = 0;
+        for (size_t begin = 0; begin < n; begin += m_tileSize)
+        {
+            const size_t m = n - begin < m_tileSize ? n - begin : m_tileSize;
+            const double* tx = x + begin;
+            const double* ty = y + begin;
+            const double* tz = z + begin;
+
+            for (size_t s = 0; s < m_siteX.size(); ++s)
+            {
+                const double sx = m_siteX[s], sy = m_siteY[s], sz = m_siteZ[s];
+                const double ex = m_eastX[s], ey = m_eastY[s];
+                const double nx = m_northX[s], ny = m_northY[s], nz = m_northZ[s];
+                const double ux = m_upX[s], uy = m_upY[s], uz = m_upZ[s];
+
+                for (size_t i = 0; i < m; ++i)
+                {
+                    double dx = tx[i] - sx;
+                    double dy = ty[i] - sy;
+                    double dz = tz[i] - sz;
+                    east[i] = ex * dx + ey * dy;
+                    north[i] = nx * dx + ny * dy + nz * dz;
+                    up[i] = ux * dx + uy * dy + uz * dz;
+                    range[i] = sqrt(dx * dx + dy * dy + dz * dz);
+                }
+                if (bVelocity)
+                {
+                    const double* tvx = vx + begin;
+                    const double* tvy = vy + begin;
+                    const double* tvz = vz + begin;
+                    for (size_t i = 0; i < m; ++i)
+                    {
+                        // the station is fixed in ECEF, d(range)/dt = (r - site) . v / range
+                        double dx = tx[i] - sx;
+                        double dy = ty[i] - sy;
+                        double dz = tz[i] - sz;
+                        rangeRate[i] = (dx * tvx[i] + dy * tvy[i] + dz * tvz[i]) / range[i];
+                    }
+                }
+
+                // sin(elevation) = up / range, masked without any trig
+                const double sinMask = bApplyMask ? m_sinMask[s] : -2.0;
+                for (size_t i = 0; i < m; ++i)
+                {
+                    if (up[i] < sinMask * range[i])
+                    {
+                        continue;
+                    }
+                    LookAngle& angle = m_results[m_resultNum];
+                    angle.station = s;
+                    angle.satellite = begin + i;
+                    double azimuth = atan2(east[i], north[i]) * toDeg;
+                    angle.azimuth = azimuth < 0.0 ? azimuth + 360.0 : azimuth;
+                    angle.elevation = atan2(up[i], sqrt(east[i] * east[i] + north[i] * north[i])) * toDeg;
+                    angle.range = range[i];
+                    angle.rangeRate = bVelocity ? rangeRate[i] : 0.0;
+                    if (++m_resultNum == m_batchSize)
+                    {
+                        flush(sink);
+                    }
+                }
+            }
+        }
+        flush(sink);
+    }
+
+    void LookAngleEngine::flush(const Sink& sink)
+    {
+        if (m_resultNum > 0)
+        {
+            sink(&m_results[0], m_resultNum);
+            m_resultNum = 0;
+        }
+    }
+}
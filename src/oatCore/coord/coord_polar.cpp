@@ -0,0 +1,36 @@
+#include "coord_polar.h"
+#include <cmath>
+
+namespace oatCoord {
+
+    PolarObserver::PolarObserver(double radius, double phi, double theta)
+        :m_radius(radius)
+        , m_phi(phi)
+        , m_theta(theta)
+    {
+        const double sinTheta = sin(theta);
+        m_x = radius * sinTheta * cos(phi);
+        m_y = radius * sinTheta * sin(phi);
+        m_z = radius * cos(theta);
+    }
+
+    void PolarObserver::convert(size_t n, const double* radius, const double* phi, const double* theta,
+                                double* oRadius, double* oPhi, double* oTheta) const
+    {
+        const double ox = m_x, oy = m_y, oz = m_z;
+        const double observerPhi = m_phi, observerTheta = m_theta;
+        for (size_t i = 0; i < n; ++i)
+        {
+            const double sinTheta = sin(theta[i]);
+            const double r = radius[i];
+            const double a = r * sinTheta * cos(phi[i]) - ox;
+            const double b = r * sinTheta * sin(phi[i]) - oy;
+            const double c = r * cos(theta[i]) - oz;
+            const double horizontal = sqrt(a * a + b * b);
+
+            oRadius[i] = sqrt(horizontal * horizontal + c * c);
+            oPhi[i] = atan2(b, a) - observerPhi;
+            oTheta[i] = atan2(horizontal, c) - observerTheta;
+        }
+    }
+}
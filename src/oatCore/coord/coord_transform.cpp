@@ -0,0 +1,310 @@
+#include "coord_transform.h"
+#include "SGP4.h"
+#include "oat_math_const.h"
+#include <cmath>
+
+namespace oatCoord {
+    EarthOrientation::EarthOrientation(double jdut1, double xp, double yp, double lod)
+    {
+        gmst = SGP4Funcs::gstime_SGP4(jdut1);
+        cosGmst = cos(gmst);
+        sinGmst = sin(gmst);
+        rotationRate = EARTH_ROTATION_RATE * (1.0 - lod / 86400.0);
+
+        // IAU-76/FK5 polar motion (Vallado polarm), transposed to map PEF -> ECEF
+        double cosxp = cos(xp);
+        double sinxp = sin(xp);
+        double cosyp = cos(yp);
+        double sinyp = sin(yp);
+        polar[0][0] = cosxp;  polar[0][1] = sinxp * sinyp;  polar[0][2] = sinxp * cosyp;
+        polar[1][0] = 0.0;    polar[1][1] = cosyp;          polar[1][2] = -sinyp;
+        polar[2][0] = -sinxp; polar[2][1] = cosxp * sinyp;  polar[2][2] = cosxp * cosyp;
+        bPolarMotion = xp != 0.0 || yp != 0.0;
+    }
+
+    // r = R * r, row major 3x3, in place on SoA arrays
+    static void rotate(const double m[3][3], size_t n, double* x, double* y, double* z)
+    {
+        const double m00 = m[0][0], m01 = m[0][1], m02 = m[0][2];
+        const double m10 = m[1][0], m11 = m[1][1], m12 = m[1][2];
+        const double m20 = m[2][0], m21 = m[2][1], m22 = m[2][2];
+        for (size_t i = 0; i < n; ++i)
+        {
+            double px = x[i], py = y[i], pz = z[i];
+            x[i] = m00 * px + m01 * py + m02 * pz;
+            y[i] = m10 * px + m11 * py + m12 * pz;
+            z[i] = m20 * px + m21 * py + m22 * pz;
+        }
+    }
+
+    // r = R^T * r
+    static void rotateTransposed(const double m[3][3], size_t n, double* x, double* y, double* z)
+    {
+        const double t[3][3] = {
+            {m[0][0], m[1][0], m[2][0]},
+            {m[0][1], m[1][1], m[2][1]},
+            {m[0][2], m[1][2], m[2][2]}};
+        rotate(t, n, x, y, z);
+    }
+
+    void temeToEcef(const EarthOrientation& orientation, size_t n,
+                    const double* x, const double* y, const double* z,
+                    const double* vx, const double* vy, const double* vz,
+                    double* ox, double* oy, double* oz,
+                    double* ovx, double* ovy, double* ovz)
+    {
+        const double c = orientation.cosGmst;
+        const double s = orientation.sinGmst;
+        const double w = orientation.rotationRate;
+        const bool bVelocity = ovx != NULL && ovy != NULL && ovz != NULL;
+
+        // TEME -> PEF, one branch free pass over the arrays, z is unchanged by the rotation
+        if (bVelocity)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                double px = c * x[i] + s * y[i];
+                double py = -s * x[i] + c * y[i];
+                double qx = c * vx[i] + s * vy[i];
+                double qy = -s * vx[i] + c * vy[i];
+                ox[i] = px;
+                oy[i] = py;
+                oz[i] = z[i];
+                // v_pef = R3(gmst) * v_teme - w x r_pef
+                ovx[i] = qx + w * py;
+                ovy[i] = qy - w * px;
+                ovz[i] = vz[i];
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                double px = c * x[i] + s * y[i];
+                double py = -s * x[i] + c * y[i];
+                ox[i] = px;
+                oy[i] = py;
+                oz[i] = z[i];
+            }
+        }
+
+        // PEF -> ECEF
+        if (orientation.bPolarMotion)
+        {
+            rotate(orientation.polar, n, ox, oy, oz);
+            if (bVelocity)
+            {
+                rotate(orientation.polar, n, ovx, ovy, ovz);
+            }
+        }
+    }
+
+    void ecefToTeme(const EarthOrientation& orientation, size_t n,
+                    const double* x, const double* y, const double* z,
+                    const double* vx, const double* vy, const double* vz,
+                    double* ox, double* oy, double* oz,
+                    double* ovx, double* ovy, double* ovz)
+    {
+        const double c = orientation.cosGmst;
+        const double s = orientation.sinGmst;
+        const double w = orientation.rotationRate;
+        const bool bVelocity = ovx != NULL && ovy != NULL && ovz != NULL;
+
+        // ECEF -> PEF in the output arrays
+        for (size_t i = 0; i < n; ++i)
+        {
+            ox[i] = x[i];
+            oy[i] = y[i];
+            oz[i] = z[i];
+        }
+        if (bVelocity)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                ovx[i] = vx[i];
+                ovy[i] = vy[i];
+                ovz[i] = vz[i];
+            }
+        }
+        if (orientation.bPolarMotion)
+        {
+            rotateTransposed(orientation.polar, n, ox, oy, oz);
+            if (bVelocity)
+            {
+                rotateTransposed(orientation.polar, n, ovx, ovy, ovz);
+            }
+        }
+
+        // PEF -> TEME
+        if (bVelocity)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                double px = ox[i];
+                double py = oy[i];
+                // v_teme = R3(-gmst) * (v_pef + w x r_pef)
+                double qx = ovx[i] - w * py;
+                double qy = ovy[i] + w * px;
+                ox[i] = c * px - s * py;
+                oy[i] = s * px + c * py;
+                ovx[i] = c * qx - s * qy;
+                ovy[i] = s * qx + c * qy;
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                double px = ox[i];
+                double py = oy[i];
+                ox[i] = c * px - s * py;
+                oy[i] = s * px + c * py;
+            }
+        }
+    }
+
+    void temeToEcef(const EarthOrientation& orientation, size_t n,
+                    const double* x, const double* y, const double* z,
+                    const double* vx, const double* vy, const double* vz,
+                    ECEFCoord* position, ECEFCoord* velocity)
+    {
+        // in blocks through SoA scratch on the stack, the kernel stays vectorizable
+        const size_t blockSize = 256;
+        double px[blockSize], py[blockSize], pz[blockSize];
+        double qx[blockSize], qy[blockSize], qz[blockSize];
+        for (size_t begin = 0; begin < n; begin += blockSize)
+        {
+            size_t m = n - begin < blockSize ? n - begin : blockSize;
+            if (velocity != NULL)
+            {
+                temeToEcef(orientation, m, x + begin, y + begin, z + begin, vx + begin, vy + begin, vz + begin,
+                           px, py, pz, qx, qy, qz);
+            }
+            else
+            {
+                temeToEcef(orientation, m, x + begin, y + begin, z + begin, NULL, NULL, NULL,
+                           px, py, pz, NULL, NULL, NULL);
+            }
+            for (size_t i = 0; i < m; ++i)
+            {
+                position[begin + i] = ECEFCoord(px[i] * 1000.0, py[i] * 1000.0, pz[i] * 1000.0);
+            }
+            if (velocity != NULL)
+            {
+                for (size_t i = 0; i < m; ++i)
+                {
+                    velocity[begin + i] = ECEFCoord(qx[i] * 1000.0, qy[i] * 1000.0, qz[i] * 1000.0);
+                }
+            }
+        }
+    }
+
+    void temeToEcef(size_t n, const double* jdut1,
+                    const double* x, const double* y, const double* z,
+                    double* ox, double* oy, double* oz)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            double gmst = SGP4Funcs::gstime_SGP4(jdut1[i]);
+            double c = cos(gmst);
+            double s = sin(gmst);
+            double px = c * x[i] + s * y[i];
+            double py = -s * x[i] + c * y[i];
+            ox[i] = px;
+            oy[i] = py;
+            oz[i] = z[i];
+        }
+    }
+
+    void ecefToGeodetic(size_t n, const double* x, const double* y, const double* z,
+                        double* lon, double* lat, double* alt)
+    {
+        const double e2 = WGS84_F * (2.0 - WGS84_F);
+        const double e4 = e2 * e2;
+        const double invA2 = 1.0 / (WGS84_A * WGS84_A);
+        const double toDeg = 180.0 / PI;
+        for (size_t i = 0; i < n; ++i)
+        {
+            double xy2 = x[i] * x[i] + y[i] * y[i];
+            double xy = sqrt(xy2);
+            double p = xy2 * invA2;
+            double q = (1.0 - e2) * invA2 * z[i] * z[i];
+            double r = (p + q - e4) / 6.0;
+            double s = e4 * p * q / (4.0 * r * r * r);
+            double t = cbrt(1.0 + s + sqrt(s * (2.0 + s)));
+            double u = r * (1.0 + t + 1.0 / t);
+            double v = sqrt(u * u + e4 * q);
+            double w = e2 * (u + v - q) / (2.0 * v);
+            double k = sqrt(u + v + w * w) - w;
+            double d = k * xy / (k + e2);
+            double dz = sqrt(d * d + z[i] * z[i]);
+            // half angle forms keep the poles and the equator well conditioned
+            lat[i] = 2.0 * atan2(z[i], d + dz) * toDeg;
+            lon[i] = atan2(y[i], x[i]) * toDeg;
+            alt[i] = (k + e2 - 1.0) / k * dz;
+        }
+    }
+
+    void geodeticToEcef(size_t n, const double* lon, const double* lat, const double* alt,
+                        double* x, double* y, double* z)
+    {
+        const double e2 = WGS84_F * (2.0 - WGS84_F);
+        const double toRad = PI / 180.0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            double sinLat = sin(lat[i] * toRad);
+            double cosLat = cos(lat[i] * toRad);
+            double sinLon = sin(lon[i] * toRad);
+            double cosLon = cos(lon[i] * toRad);
+            // prime vertical radius of curvature
+            double rn = WGS84_A / sqrt(1.0 - e2 * sinLat * sinLat);
+            x[i] = (rn + alt[i]) * cosLat * cosLon;
+            y[i] = (rn + alt[i]) * cosLat * sinLon;
+            z[i] = (rn * (1.0 - e2) + alt[i]) * sinLat;
+        }
+    }
+
+    void ecefToGeodetic(size_t n, const ECEFCoord* ecef, GeoCoord* geo)
+    {
+        const size_t blockSize = 256;
+        double x[blockSize], y[blockSize], z[blockSize];
+        double lon[blockSize], lat[blockSize], alt[blockSize];
+        for (size_t begin = 0; begin < n; begin += blockSize)
+        {
+            size_t m = n - begin < blockSize ? n - begin : blockSize;
+            for (size_t i = 0; i < m; ++i)
+            {
+                x[i] = ecef[begin + i].x;
+                y[i] = ecef[begin + i].y;
+                z[i] = ecef[begin + i].z;
+            }
+            ecefToGeodetic(m, x, y, z, lon, lat, alt);
+            for (size_t i = 0; i < m; ++i)
+            {
+                geo[begin + i] = GeoCoord(lon[i], lat[i], alt[i]);
+            }
+        }
+    }
+
+    void geodeticToEcef(size_t n, const GeoCoord* geo, ECEFCoord* ecef)
+    {
+        const size_t blockSize = 256;
+        double lon[blockSize], lat[blockSize], alt[blockSize];
+        double x[blockSize], y[blockSize], z[blockSize];
+        for (size_t begin = 0; begin < n; begin += blockSize)
+        {
+            size_t m = n - begin < blockSize ? n - begin : blockSize;
+            for (size_t i = 0; i < m; ++i)
+            {
+                lon[i] = geo[begin + i].Lontitude;
+                lat[i] = geo[begin + i].Latitude;
+                alt[i] = geo[begin + i].Altitude;
+            }
+            geodeticToEcef(m, lon, lat, alt, x, y, z);
+            for (size_t i = 0; i < m; ++i)
+            {
+                ecef[begin + i] = ECEFCoord(x[i], y[i], z[i]);
+            }
+        }
+    }
+}
@@ -0,0 +1,252 @@
+#include "oat_calendar.h"
+#include <cmath>
+
+namespace oat
+{
+    namespace
+    {
+        typedef long long int64;
+
+        const int64 DAY_US = 86400000000LL;
+        // JD day 0 of the 1970-01-01 civil day, which starts at JD 2440587.5
+        const int64 JD_1970 = 2440587;
+        // dates converted per chunk by the batch formatter
+        const size_t CHUNK = 64;
+
+        // floor(a / b) for b > 0
+        inline int64 floorDiv(int64 a, int64 b)
+        {
+            int64 q = a / b;
+            return q - (a - q * b < 0 ? 1 : 0);
+        }
+
+        // days from 1970-01-01 of a civil date, Hinnant's days_from_civil
+        inline int64 daysFromCivil(int64 y, int64 m, int64 d)
+        {
+            y -= m <= 2 ? 1 : 0;
+            const int64 era = (y >= 0 ? y : y - 399) / 400;
+            const int64 yoe = y - era * 400;
+            const int64 doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+            const int64 doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+            return era * 146097 + doe - 719468;
+        }
+
+        // civil date of days from 1970-01-01, Hinnant's civil_from_days
+        inline void civilFromDays(int64 z, CalendarTime& cal)
+        {
+            z += 719468;
+            const int64 era = (z >= 0 ? z : z - 146096) / 146097;
+            const int64 doe = z - era * 146097;
+            const int64 yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+            const int64 doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+            const int64 mp = (5 * doy + 2) / 153;
+            const int64 m = mp < 10 ? mp + 3 : mp - 9;
+            cal.year = (int)(yoe + era * 400 + (m <= 2 ? 1 : 0));
+            cal.month = (int)m;
+            cal.day = (int)(doy - (153 * mp + 2) / 5 + 1);
+        }
+
+        // microseconds from the JD day start (noon) of a calendar time, and its JD day
+        inline int64 toMicroseconds(const CalendarTime& cal, int64& jdDay)
+        {
+            jdDay = daysFromCivil(cal.year, cal.month, cal.day) + JD_1970;
+            return (((int64)cal.hour * 60 + cal.minute) * 60 + cal.second) * 1000000 + cal.microsecond + DAY_US / 2;
+        }
+
+        // calendar time of a JD day and microseconds from its start, any number of them
+        inline void fromMicroseconds(int64 jdDay, int64 us, CalendarTime& cal)
+        {
+            us -= DAY_US / 2;
+            const int64 carry = floorDiv(us, DAY_US);
+            us -= carry * DAY_US;
+            civilFromDays(jdDay + carry - JD_1970, cal);
+            const int64 seconds = us / 1000000;
+            cal.microsecond = (int)(us - seconds * 1000000);
+            cal.hour = (int)(seconds / 3600);
+            cal.minute = (int)(seconds / 60 % 60);
+            cal.second = (int)(seconds % 60);
+        }
+
+        inline void writeDigits(char* text, int value, int count)
+        {
+            for (int i = count - 1; i >= 0; --i)
+            {
+                text[i] = (char)('0' + value % 10);
+                value /= 10;
+            }
+        }
+
+        // count digits at text, false at the first non digit (which also stops at the end of text)
+        inline bool readDigits(const char* text, int count, int& value)
+        {
+            value = 0;
+            for (int i = 0; i < count; ++i)
+            {
+                const unsigned digit = (unsigned)(text[i] - '0');
+                if (digit > 9)
+                {
+                    return false;
+                }
+                value = value * 10 + (int)digit;
+            }
+            return true;
+        }
+
+        inline int daysInMonth(int year, int month)
+        {
+            static const int DAYS[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+            const bool bLeap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+            return DAYS[month - 1] + (month == 2 && bLeap ? 1 : 0);
+        }
+    }
+
+    void calendarToJd(const CalendarTime* cal, size_t n, JulianDate* jd)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            int64 day;
+            int64 us = toMicroseconds(cal[i], day);
+            const int64 carry = floorDiv(us, DAY_US);
+            jd[i].day = (double)(day + carry);
+            jd[i].fraction = (double)(us - carry * DAY_US) / (double)DAY_US;
+        }
+    }
+
+    void calendarToJd(const CalendarTime* cal, size_t n, double* jd)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            int64 day;
+            int64 us = toMicroseconds(cal[i], day);
+            jd[i] = (double)day + (double)us / (double)DAY_US;
+        }
+    }
+
+    void jdToCalendar(const JulianDate* jd, size_t n, CalendarTime* cal)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            const int64 us = (int64)floor(jd[i].fraction * (double)DAY_US + 0.5);
+            fromMicroseconds((int64)jd[i].day, us, cal[i]);
+        }
+    }
+
+    void jdToCalendar(const double* jd, size_t n, CalendarTime* cal)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            const double day = floor(jd[i]);
+            const int64 us = (int64)floor((jd[i] - day) * (double)DAY_US + 0.5);
+            fromMicroseconds((int64)day, us, cal[i]);
+        }
+    }
+
+    bool formatIso8601(const CalendarTime& cal, char* text)
+    {
+        if (cal.year < 0 || cal.year > 9999)
+        {
+            return false;
+        }
+        writeDigits(text, cal.year, 4);
+        text[4] = '-';
+        writeDigits(text + 5, cal.month, 2);
+        text[7] = '-';
+        writeDigits(text + 8, cal.day, 2);
+        text[10] = 'T';
+        writeDigits(text + 11, cal.hour, 2);
+        text[13] = ':';
+        writeDigits(text + 14, cal.minute, 2);
+        text[16] = ':';
+        writeDigits(text + 17, cal.second, 2);
+        text[19] = '.';
+        writeDigits(text + 20, cal.microsecond, 6);
+        text[26] = 'Z';
+        text[27] = '\0';
+        return true;
+    }
+
+    size_t formatIso8601(const JulianDate* jd, size_t n, char* text)
+    {
+        CalendarTime cal[CHUNK];
+        for (size_t begin = 0; begin < n; begin += CHUNK)
+        {
+            const size_t count = n - begin < CHUNK ? n - begin : CHUNK;
+            jdToCalendar(jd + begin, count, cal);
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (!formatIso8601(cal[i], text + (begin + i) * (ISO8601_SIZE + 1)))
+                {
+                    return begin + i;
+                }
+            }
+        }
+        return n;
+    }
+
+    bool parseIso8601(const char* text, CalendarTime& cal)
+    {
+        cal.hour = 0;
+        cal.minute = 0;
+        cal.second = 0;
+        cal.microsecond = 0;
+        if (!readDigits(text, 4, cal.year) || text[4] != '-' || !readDigits(text + 5, 2, cal.month) ||
+            text[7] != '-' || !readDigits(text + 8, 2, cal.day))
+        {
+            return false;
+        }
+        if (cal.month < 1 || cal.month > 12 || cal.day < 1 || cal.day > daysInMonth(cal.year, cal.month))
+        {
+            return false;
+        }
+        if (text[10] == '\0')
+        {
+            return true;
+        }
+
+        if ((text[10] != 'T' && text[10] != ' ') || !readDigits(text + 11, 2, cal.hour) || text[13] != ':' ||
+            !readDigits(text + 14, 2, cal.minute) || text[16] != ':' || !readDigits(text + 17, 2, cal.second))
+        {
+            return false;
+        }
+        if (cal.hour > 23 || cal.minute > 59 || cal.second > 60)
+        {
+            return false;
+        }
+
+        const char* end = text + 19;
+        if (*end == '.')
+        {
+            ++end;
+            int scale = 100000;
+            const char* first = end;
+            for (; (unsigned)(*end - '0') <= 9; ++end)
+            {
+                cal.microsecond += (*end - '0') * scale;
+                scale /= 10;
+            }
+            if (end == first)
+            {
+                return false;
+            }
+        }
+        if (*end == 'Z')
+        {
+            ++end;
+        }
+        return *end == '\0';
+    }
+
+    size_t parseIso8601(const char* const* text, size_t n, JulianDate* jd)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            CalendarTime cal;
+            if (!parseIso8601(text[i], cal))
+            {
+                return i;
+            }
+            calendarToJd(&cal, 1, jd + i);
+        }
+        return n;
+    }
+}
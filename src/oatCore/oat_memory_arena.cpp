@@ -0,0 +1,68 @@
+#include "oat_memory_arena.h"
+#include <stdint.h>
+
+namespace oat
+{
+    MemoryArena::MemoryArena(size_t slabSize)
+        :m_cursor(NULL)
+        , m_end(NULL)
+        , m_slabSize(slabSize)
+        , m_reservedSize(0)
+        , m_usedSize(0)
+    {
+
+    }
+
+    MemoryArena::~MemoryArena()
+    {
+        release();
+    }
+
+    void* MemoryArena::allocate(size_t size, size_t align)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        uintptr_t cursor = ((uintptr_t)m_cursor + align - 1) & ~(uintptr_t)(align - 1);
+        if (m_cursor == NULL || cursor + size > (uintptr_t)m_end)
+        {
+            size_t slabSize = size + align > m_slabSize ? size + align : m_slabSize;
+            char* slab = static_cast<char*>(::operator new(slabSize));
+            m_slabs.push_back(slab);
+            m_reservedSize += slabSize;
+            cursor = ((uintptr_t)slab + align - 1) & ~(uintptr_t)(align - 1);
+            if (slabSize > m_slabSize && m_cursor != NULL)
+            {
+                // oversized request, keep filling the current slab afterwards
+                m_usedSize += size;
+                return (void*)cursor;
+            }
+            m_end = slab + slabSize;
+        }
+        m_cursor = (char*)(cursor + size);
+        m_usedSize += size;
+        return (void*)cursor;
+    }
+
+    void MemoryArena::deallocate(void* p, size_t size)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // vectors growing at the top of the slab can reuse their old block
+        if ((char*)p + size == m_cursor)
+        {
+            m_cursor = (char*)p;
+            m_usedSize -= size;
+        }
+    }
+
+    void MemoryArena::release()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t i = 0; i < m_slabs.size(); ++i)
+        {
+            ::operator delete(m_slabs[i]);
+        }
+        m_slabs.clear();
+        m_cursor = m_end = NULL;
+        m_reservedSize = 0;
+        m_usedSize = 0;
+    }
+}
@@ -0,0 +1,82 @@
+#include "oat_thread_pool.h"
+
+namespace oat
+{
+    ThreadPool::ThreadPool(unsigned int threadNum)
+        :m_busy(0)
+        , m_stop(false)
+    {
+        if (threadNum == 0)
+        {
+            threadNum = std::thread::hardware_concurrency();
+        }
+        if (threadNum == 0)
+        {
+            threadNum = 1;
+        }
+        m_workers.reserve(threadNum);
+        for (unsigned int i = 0; i < threadNum; ++i)
+        {
+            m_workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+            m_tasks.clear();
+        }
+        m_taskCond.notify_all();
+        for (size_t i = 0; i < m_workers.size(); ++i)
+        {
+            m_workers[i].join();
+        }
+    }
+
+    void ThreadPool::enqueue(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.push_back(std::move(task));
+        }
+        m_taskCond.notify_one();
+    }
+
+    void ThreadPool::wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idleCond.wait(lock, [this] { return m_tasks.empty() && m_busy == 0; });
+    }
+
+    void ThreadPool::workerLoop()
+    {
+        for (;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_taskCond.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+                if (m_stop)
+                {
+                    return;
+                }
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+                ++m_busy;
+            }
+
+            task();
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                --m_busy;
+                if (m_busy == 0 && m_tasks.empty())
+                {
+                    m_idleCond.notify_all();
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,298 @@
+#include "oat_time_scale.h"
+#include "oat_math_const.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+
+namespace oat
+{
+    namespace
+    {
+        // TT - TAI | unit: s
+        const double TT_MINUS_TAI = 32.184;
+
+        // TAI - UTC from 1972 on, MJD (UTC) of the step and the new offset
+        const double LEAP_SECONDS[][2] = {
+            {41317.0, 10.0}, {41499.0, 11.0}, {41683.0, 12.0}, {42048.0, 13.0}, {42413.0, 14.0},
+            {42778.0, 15.0}, {43144.0, 16.0}, {43509.0, 17.0}, {43874.0, 18.0}, {44239.0, 19.0},
+            {44786.0, 20.0}, {45151.0, 21.0}, {45516.0, 22.0}, {46247.0, 23.0}, {47161.0, 24.0},
+            {47892.0, 25.0}, {48257.0, 26.0}, {48804.0, 27.0}, {49169.0, 28.0}, {49534.0, 29.0},
+            {50083.0, 30.0}, {50630.0, 31.0}, {51179.0, 32.0}, {53736.0, 33.0}, {54832.0, 34.0},
+            {56109.0, 35.0}, {57204.0, 36.0}, {57754.0, 37.0}};
+
+        double toMjd(const JulianDate& jd)
+        {
+            return (jd.day - 2400000.0) + (jd.fraction - 0.5);
+        }
+
+        // fixed width field of an IERS record, false if it is blank or not a number
+        bool field(const std::string& line, size_t begin, size_t size, double& value)
+        {
+            if (line.size() < begin + size)
+            {
+                return false;
+            }
+            std::string text = line.substr(begin, size);
+            const char* start = text.c_str();
+            char* end = NULL;
+            value = strtod(start, &end);
+            return end != start;
+        }
+    }
+
+    TimeScaleService::TimeScaleService()
+        :m_leapCursor(0)
+        , m_eopCursor(0)
+    {
+        for (size_t i = 0; i < sizeof(LEAP_SECONDS) / sizeof(LEAP_SECONDS[0]); ++i)
+        {
+            m_leapMjd.push_back(LEAP_SECONDS[i][0]);
+            m_leapOffset.push_back(LEAP_SECONDS[i][1]);
+        }
+    }
+
+    bool TimeScaleService::loadLeapSeconds(const char* path)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            return false;
+        }
+
+        std::vector<std::pair<double, double> > entries;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            line = line.substr(0, line.find('#'));
+            std::istringstream stream(line);
+            std::vector<double> values;
+            double value;
+            while (stream >> value)
+            {
+                values.push_back(value);
+            }
+            if (values.size() < 2)
+            {
+                continue;
+            }
+            // leap-seconds.list: NTP seconds, offset; Leap_Second.dat: MJD, day, month, year, offset
+            if (values[0] > 1e9)
+            {
+                entries.push_back(std::make_pair(15020.0 + values[0] / 86400.0, values[1]));
+            }
+            else
+            {
+                entries.push_back(std::make_pair(values[0], values.back()));
+            }
+        }
+        if (entries.empty())
+        {
+            return false;
+        }
+
+        std::sort(entries.begin(), entries.end());
+        m_leapMjd.clear();
+        m_leapOffset.clear();
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            m_leapMjd.push_back(entries[i].first);
+            m_leapOffset.push_back(entries[i].second);
+        }
+        m_leapCursor = 0;
+        return true;
+    }
+
+    bool TimeScaleService::loadEop(const char* path)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            return false;
+        }
+
+        const double arcsecToRad = PI / (180.0 * 3600.0);
+        std::vector<EopEntry> entries;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            // IERS finals columns: MJD 8-15, PM-x 19-27, PM-y 38-46 (arcsec), UT1-UTC 59-68 (s), LOD 80-86 (ms)
+            EopEntry entry;
+            if (!field(line, 7, 8, entry.mjd) || !field(line, 58, 10, entry.dut1))
+            {
+                continue;
+            }
+            if (!field(line, 18, 9, entry.xp) || !field(line, 37, 9, entry.yp))
+            {
+                entry.xp = 0.0;
+                entry.yp = 0.0;
+            }
+            if (!field(line, 79, 7, entry.lod))
+            {
+                entry.lod = 0.0;
+            }
+            entry.xp *= arcsecToRad;
+            entry.yp *= arcsecToRad;
+            entry.lod *= 1e-3;
+            entries.push_back(entry);
+        }
+        if (entries.empty())
+        {
+            return false;
+        }
+
+        struct ByMjd {
+            bool operator () (const EopEntry& a, const EopEntry& b) const {return a.mjd < b.mjd;}
+        };
+        std::sort(entries.begin(), entries.end(), ByMjd());
+        m_eop.swap(entries);
+        m_eopMjd.resize(m_eop.size());
+        for (size_t i = 0; i < m_eop.size(); ++i)
+        {
+            m_eopMjd[i] = m_eop[i].mjd;
+        }
+        m_eopCursor = 0;
+        return true;
+    }
+
+    size_t TimeScaleService::find(const std::vector<double>& table, double mjd, size_t& cursor)
+    {
+        const size_t n = table.size();
+        if (n == 0 || mjd < table[0])
+        {
+            return (size_t)-1;
+        }
+        // the interval of the last lookup, then the next one: O(1) for monotonic streams
+        size_t i = cursor < n ? cursor : 0;
+        for (int k = 0; k < 2 && i < n; ++k, ++i)
+        {
+            if (table[i] <= mjd && (i + 1 == n || mjd < table[i + 1]))
+            {
+                cursor = i;
+                return i;
+            }
+        }
+        i = (size_t)(std::upper_bound(table.begin(), table.end(), mjd) - table.begin()) - 1;
+        cursor = i;
+        return i;
+    }
+
+    double TimeScaleService::taiMinusUtc(const JulianDate& utc)
+    {
+        size_t i = find(m_leapMjd, toMjd(utc), m_leapCursor);
+        if (i == (size_t)-1)
+        {
+            return m_leapOffset.empty() ? 0.0 : m_leapOffset.front();
+        }
+        return m_leapOffset[i];
+    }
+
+    bool TimeScaleService::eopAt(const JulianDate& utc, EopEntry& eop)
+    {
+        const double mjd = toMjd(utc);
+        if (m_eop.empty())
+        {
+            eop.mjd = mjd;
+            eop.xp = 0.0;
+            eop.yp = 0.0;
+            eop.dut1 = 0.0;
+            eop.lod = 0.0;
+            return false;
+        }
+
+        size_t i = find(m_eopMjd, mjd, m_eopCursor);
+        if (i == (size_t)-1 || i + 1 == m_eop.size())
+        {
+            eop = i == (size_t)-1 ? m_eop.front() : m_eop.back();
+            bool bInside = i != (size_t)-1 && mjd == m_eop.back().mjd;
+            eop.mjd = mjd;
+            return bInside;
+        }
+
+        const EopEntry& a = m_eop[i];
+        const EopEntry& b = m_eop[i + 1];
+        double t = (mjd - a.mjd) / (b.mjd - a.mjd);
+        // a leap second makes dUT1 jump by 1 s, interpolate the continuous UT1 - TAI instead
+        double dut1 = b.dut1;
+        if (dut1 - a.dut1 > 0.5)
+        {
+            dut1 -= 1.0;
+        }
+        else if (dut1 - a.dut1 < -0.5)
+        {
+            dut1 += 1.0;
+        }
+        eop.mjd = mjd;
+        eop.xp = a.xp + (b.xp - a.xp) * t;
+        eop.yp = a.yp + (b.yp - a.yp) * t;
+        eop.dut1 = a.dut1 + (dut1 - a.dut1) * t;
+        eop.lod = a.lod + (b.lod - a.lod) * t;
+        return true;
+    }
+
+    double TimeScaleService::utcTo(const JulianDate& utc, TimeScale to)
+    {
+        switch (to)
+        {
+        case TIMESCALE_TAI:
+            return taiMinusUtc(utc);
+        case TIMESCALE_TT:
+            return taiMinusUtc(utc) + TT_MINUS_TAI;
+        case TIMESCALE_UT1:
+        {
+            EopEntry eop;
+            eopAt(utc, eop);
+            return eop.dut1;
+        }
+        default:
+            return 0.0;
+        }
+    }
+
+    JulianDate TimeScaleService::convert(const JulianDate& jd, TimeScale from, TimeScale to)
+    {
+        if (from == to)
+        {
+            return jd;
+        }
+
+        // through UTC; the offsets are looked up at UTC, so guess it first and look up again
+        JulianDate utc = jd;
+        if (from != TIMESCALE_UTC)
+        {
+            JulianDate guess = jd;
+            guess.addSeconds(-utcTo(jd, from));
+            utc.addSeconds(-utcTo(guess, from));
+        }
+        JulianDate out = utc;
+        out.addSeconds(utcTo(utc, to));
+        return out;
+    }
+
+    void TimeScaleService::convert(const JulianDate* jd, size_t n, TimeScale from, TimeScale to, JulianDate* out)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            out[i] = convert(jd[i], from, to);
+        }
+    }
+
+    void TimeScaleService::convert(const double* jd, size_t n, TimeScale from, TimeScale to, double* out)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            out[i] = convert(JulianDate(jd[i]), from, to).jd();
+        }
+    }
+
+    oatCoord::EarthOrientation TimeScaleService::earthOrientation(const JulianDate& utc)
+    {
+        EopEntry eop;
+        eopAt(utc, eop);
+        JulianDate ut1 = utc;
+        ut1.addSeconds(eop.dut1);
+        return oatCoord::EarthOrientation(ut1.jd(), eop.xp, eop.yp, eop.lod);
+    }
+}
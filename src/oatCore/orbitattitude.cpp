@@ -0,0 +1,196 @@
+#include "orbitattitude.h"
+#include "oat_math_const.h"
+#include <cmath>
+
+namespace oat
+{
+    namespace
+    {
+        const double DEG_TO_RAD = PI / 180.0;
+
+        /*
+         * Body axes a (x), b (y), c (z), given in the frame, are the columns of the body to frame
+         * matrix. Each quaternion component comes from the diagonal and its sign from the off
+         * diagonal terms (w >= 0), so there is no branch and the batch loops vectorize. Small
+         * components lose a few digits (~1e-8), far below anything visible.
+         */
+        inline void axesToQuat(double ax, double ay, double az,
+                               double bx, double by, double bz,
+                               double cx, double cy, double cz, Quat& q)
+        {
+            double w = 0.5 * std::sqrt(std::fmax(0.0, 1.0 + ax + by + cz));
+            double x = 0.5 * std::sqrt(std::fmax(0.0, 1.0 + ax - by - cz));
+            double y = 0.5 * std::sqrt(std::fmax(0.0, 1.0 - ax + by - cz));
+            double z = 0.5 * std::sqrt(std::fmax(0.0, 1.0 - ax - by + cz));
+            x = std::copysign(x, bz - cy);
+            y = std::copysign(y, cx - az);
+            z = std::copysign(z, ay - bx);
+            double invLen = 1.0 / std::sqrt(x * x + y * y + z * z + w * w);
+            q._v[0] = x * invLen;
+            q._v[1] = y * invLen;
+            q._v[2] = z * invLen;
+            q._v[3] = w * invLen;
+        }
+
+        inline void nadirKernel(double x, double y, double z, double vx, double vy, double vz, Quat& q)
+        {
+            // z to nadir
+            double invR = 1.0 / std::sqrt(x * x + y * y + z * z);
+            double cx = -x * invR, cy = -y * invR, cz = -z * invR;
+            // y to negative orbit normal
+            double hx = y * vz - z * vy, hy = z * vx - x * vz, hz = x * vy - y * vx;
+            double invH = 1.0 / std::sqrt(hx * hx + hy * hy + hz * hz);
+            double bx = -hx * invH, by = -hy * invH, bz = -hz * invH;
+            // x = y ^ z
+            axesToQuat(by * cz - bz * cy, bz * cx - bx * cz, bx * cy - by * cx, bx, by, bz, cx, cy, cz, q);
+        }
+
+        inline void velocityKernel(double x, double y, double z, double vx, double vy, double vz, Quat& q)
+        {
+            // x along velocity
+            double invV = 1.0 / std::sqrt(vx * vx + vy * vy + vz * vz);
+            double ax = vx * invV, ay = vy * invV, az = vz * invV;
+            // y to negative orbit normal
+            double hx = y * vz - z * vy, hy = z * vx - x * vz, hz = x * vy - y * vx;
+            double invH = 1.0 / std::sqrt(hx * hx + hy * hy + hz * hz);
+            double bx = -hx * invH, by = -hy * invH, bz = -hz * invH;
+            // z = x ^ y
+            axesToQuat(ax, ay, az, bx, by, bz, ay * bz - az * by, az * bx - ax * bz, ax * by - ay * bx, q);
+        }
+
+        inline void sunKernel(double x, double y, double z, double vx, double vy, double vz, const Vec3& sun, Quat& q)
+        {
+            double cx = sun._v[0], cy = sun._v[1], cz = sun._v[2];
+            // x = normal ^ sun, falls back to the frame pole when the orbit normal points to the sun
+            double hx = y * vz - z * vy, hy = z * vx - x * vz, hz = x * vy - y * vx;
+            double ax = hy * cz - hz * cy, ay = hz * cx - hx * cz, az = hx * cy - hy * cx;
+            double len2 = ax * ax + ay * ay + az * az;
+            bool bDegenerate = len2 <= 1e-12 * (hx * hx + hy * hy + hz * hz);
+            ax = bDegenerate ? -cy : ax;
+            ay = bDegenerate ? cx : ay;
+            az = bDegenerate ? 0.0 : az;
+            len2 = bDegenerate ? cx * cx + cy * cy : len2;
+            double invA = 1.0 / std::sqrt(len2);
+            ax *= invA; ay *= invA; az *= invA;
+            // y = z ^ x
+            axesToQuat(ax, ay, az, cy * az - cz * ay, cz * ax - cx * az, cx * ay - cy * ax, cx, cy, cz, q);
+        }
+    }
+
+    AttitudeLaw::~AttitudeLaw()
+    {
+
+    }
+
+    void AttitudeLaw::attitudes(double jd, size_t n, const double* x, const double* y, const double* z,
+                                const double* vx, const double* vy, const double* vz, Quat* q) const
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            q[i] = attitude(jd, Vec3(x[i], y[i], z[i]), Vec3(vx[i], vy[i], vz[i]));
+        }
+    }
+
+    Quat InertialAttitude::attitude(double /*jd*/, const Vec3& /*position*/, const Vec3& /*velocity*/) const
+    {
+        return m_quat;
+    }
+
+    void InertialAttitude::attitudes(double /*jd*/, size_t n, const double* /*x*/, const double* /*y*/, const double* /*z*/,
+                                     const double* /*vx*/, const double* /*vy*/, const double* /*vz*/, Quat* q) const
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            q[i] = m_quat;
+        }
+    }
+
+    Quat NadirAttitude::attitude(double /*jd*/, const Vec3& position, const Vec3& velocity) const
+    {
+        Quat q;
+        nadirKernel(position._v[0], position._v[1], position._v[2], velocity._v[0], velocity._v[1], velocity._v[2], q);
+        return q;
+    }
+
+    void NadirAttitude::attitudes(double /*jd*/, size_t n, const double* x, const double* y, const double* z,
+                                  const double* vx, const double* vy, const double* vz, Quat* q) const
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            nadirKernel(x[i], y[i], z[i], vx[i], vy[i], vz[i], q[i]);
+        }
+    }
+
+    Quat VelocityAttitude::attitude(double /*jd*/, const Vec3& position, const Vec3& velocity) const
+    {
+        Quat q;
+        velocityKernel(position._v[0], position._v[1], position._v[2], velocity._v[0], velocity._v[1], velocity._v[2], q);
+        return q;
+    }
+
+    void VelocityAttitude::attitudes(double /*jd*/, size_t n, const double* x, const double* y, const double* z,
+                                     const double* vx, const double* vy, const double* vz, Quat* q) const
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            velocityKernel(x[i], y[i], z[i], vx[i], vy[i], vz[i], q[i]);
+        }
+    }
+
+    Quat SunPointingAttitude::attitude(double jd, const Vec3& position, const Vec3& velocity) const
+    {
+        Quat q;
+        sunKernel(position._v[0], position._v[1], position._v[2], velocity._v[0], velocity._v[1], velocity._v[2],
+                  sunDirectionAtJD(jd), q);
+        return q;
+    }
+
+    void SunPointingAttitude::attitudes(double jd, size_t n, const double* x, const double* y, const double* z,
+                                        const double* vx, const double* vy, const double* vz, Quat* q) const
+    {
+        const Vec3 sun = sunDirectionAtJD(jd);
+        for (size_t i = 0; i < n; ++i)
+        {
+            sunKernel(x[i], y[i], z[i], vx[i], vy[i], vz[i], sun, q[i]);
+        }
+    }
+
+    Vec3 sunDirectionAtJD(double jd)
+    {
+        // Astronomical Almanac low precision formula, valid 1950 - 2050
+        double n = jd - 2451545.0;
+        double L = (280.460 + 0.9856474 * n) * DEG_TO_RAD;
+        double g = (357.528 + 0.9856003 * n) * DEG_TO_RAD;
+        double lambda = L + (1.915 * std::sin(g) + 0.020 * std::sin(2.0 * g)) * DEG_TO_RAD;
+        double epsilon = (23.439 - 0.0000004 * n) * DEG_TO_RAD;
+        double sinLambda = std::sin(lambda);
+        return Vec3(std::cos(lambda), std::cos(epsilon) * sinLambda, std::sin(epsilon) * sinLambda);
+    }
+
+    void nlerp(const Quat* from, const Quat* to, size_t n, double t, Quat* out)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            const double* a = from[i]._v;
+            const double* b = to[i]._v;
+            double s = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3] < 0.0 ? -t : t;
+            double x = a[0] * (1.0 - t) + b[0] * s;
+            double y = a[1] * (1.0 - t) + b[1] * s;
+            double z = a[2] * (1.0 - t) + b[2] * s;
+            double w = a[3] * (1.0 - t) + b[3] * s;
+            double invLen = 1.0 / std::sqrt(x * x + y * y + z * z + w * w);
+            out[i]._v[0] = x * invLen;
+            out[i]._v[1] = y * invLen;
+            out[i]._v[2] = z * invLen;
+            out[i]._v[3] = w * invLen;
+        }
+    }
+
+    void slerp(const Quat* from, const Quat* to, size_t n, double t, Quat* out)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            out[i].slerp(t, from[i], to[i]);
+        }
+    }
+}
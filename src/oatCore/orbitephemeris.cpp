@@ -0,0 +1,57 @@
+#include "orbitephemeris.h"
+#include <cmath>
+
+namespace oat
+{
+    EphemerisGenerator::EphemerisGenerator(const OrbitModel& model, double beginJD, double endJD, double dDeltaTime, size_t batchSize)
+        :m_model(model)
+        , m_beginJD(beginJD)
+        , m_deltaTime(dDeltaTime)
+        , m_sampleNum(0)
+        , m_nextSample(0)
+        , m_bFailed(false)
+        , m_jd(batchSize > 0 ? batchSize : 1)
+        , m_batch(batchSize > 0 ? batchSize : 1)
+        , m_batchSize(0)
+    {
+        if (dDeltaTime > 0.0 && endJD >= beginJD)
+        {
+            // tolerate rounding of an end time meant to be on the grid
+            m_sampleNum = (size_t)floor((endJD - beginJD) / dDeltaTime + 1e-9) + 1;
+        }
+    }
+
+    bool EphemerisGenerator::next()
+    {
+        m_batchSize = 0;
+        if (m_bFailed || m_nextSample >= m_sampleNum)
+        {
+            return false;
+        }
+
+        size_t n = m_sampleNum - m_nextSample;
+        n = n < m_jd.size() ? n : m_jd.size();
+        for (size_t i = 0; i < n; ++i)
+        {
+            // from the index, so long spans do not accumulate step rounding
+            m_jd[i] = m_beginJD + (double)(m_nextSample + i) * m_deltaTime;
+        }
+        if (!m_model.propagate(&m_jd[0], n, &m_batch[0]))
+        {
+            m_bFailed = true;
+            return false;
+        }
+        m_nextSample += n;
+        m_batchSize = n;
+        return true;
+    }
+
+    EphemerisGenerator::iterator EphemerisGenerator::begin()
+    {
+        if (m_batchSize == 0 && !next())
+        {
+            return end();
+        }
+        return iterator(this, 0);
+    }
+}
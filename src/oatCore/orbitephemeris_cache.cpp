@@ -0,0 +1,117 @@
+#include "orbitephemeris_cache.h"
+
+namespace oat
+{
+    bool EphemerisKey::operator < (const EphemerisKey& other) const
+    {
+        if (beginTime != other.beginTime) return beginTime < other.beginTime;
+        if (endTime != other.endTime) return endTime < other.endTime;
+        if (deltaTime != other.deltaTime) return deltaTime < other.deltaTime;
+        if (opsmode != other.opsmode) return opsmode < other.opsmode;
+        if (gravity != other.gravity) return gravity < other.gravity;
+        int cmp = tleLine2nd.compare(other.tleLine2nd);
+        if (cmp != 0) return cmp < 0;
+        return tleLine1st < other.tleLine1st;
+    }
+
+    EphemerisCache& EphemerisCache::instance()
+    {
+        static EphemerisCache cache;
+        return cache;
+    }
+
+    EphemerisCache::EphemerisCache()
+        :m_purgeSize(64)
+        , m_bEnabled(false)
+        , m_hits(0)
+        , m_misses(0)
+    {
+
+    }
+
+    EphemerisCache::Block EphemerisCache::find(const EphemerisKey& key)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::map<EphemerisKey, std::weak_ptr<const OrbitDataVector> >::iterator it = m_blocks.find(key);
+        if (it != m_blocks.end())
+        {
+            Block block = it->second.lock();
+            if (block)
+            {
+                ++m_hits;
+                return block;
+            }
+            m_blocks.erase(it);
+        }
+        ++m_misses;
+        return Block();
+    }
+
+    EphemerisCache::Block EphemerisCache::insert(const EphemerisKey& key, OrbitDataVector& data)
+    {
+        // build the block outside of the lock, shared blocks always live on the heap
+        std::shared_ptr<OrbitDataVector> block;
+        if (data.get_allocator().getArena() == NULL)
+        {
+            block = std::make_shared<OrbitDataVector>(std::move(data));
+        }
+        else
+        {
+            block = std::make_shared<OrbitDataVector>(data.begin(), data.end());
+        }
+        OrbitDataVector().swap(data);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::weak_ptr<const OrbitDataVector>& entry = m_blocks[key];
+        Block existing = entry.lock();
+        if (existing)
+        {
+            return existing;
+        }
+        entry = block;
+        if (m_blocks.size() >= 2 * m_purgeSize)
+        {
+            purge();
+        }
+        return block;
+    }
+
+    void EphemerisCache::purge()
+    {
+        std::map<EphemerisKey, std::weak_ptr<const OrbitDataVector> >::iterator it = m_blocks.begin();
+        while (it != m_blocks.end())
+        {
+            if (it->second.expired())
+            {
+                m_blocks.erase(it++);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        m_purgeSize = m_blocks.size() > 64 ? m_blocks.size() : 64;
+    }
+
+    EphemerisCache::Stats EphemerisCache::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Stats stats;
+        stats.hits = m_hits;
+        stats.misses = m_misses;
+        stats.blocks = 0;
+        std::map<EphemerisKey, std::weak_ptr<const OrbitDataVector> >::const_iterator it;
+        for (it = m_blocks.begin(); it != m_blocks.end(); ++it)
+        {
+            stats.blocks += it->second.expired() ? 0 : 1;
+        }
+        return stats;
+    }
+
+    void EphemerisCache::resetStats()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_hits = 0;
+        m_misses = 0;
+    }
+}
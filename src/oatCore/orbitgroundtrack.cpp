@@ -0,0 +1,179 @@
+#include "orbitgroundtrack.h"
+#include "coord/coord_transform.h"
+#include "oat_math_const.h"
+#include <cmath>
+
+namespace oat
+{
+    // refinement samples of one gap at most
+    static const size_t MAX_REFINE = 64;
+
+    void GroundTrackGenerator::Buffer::resize(size_t n)
+    {
+        jd.resize(n);
+        data.resize(n);
+        x.resize(n);
+        y.resize(n);
+        z.resize(n);
+        lon.resize(n);
+        lat.resize(n);
+        alt.resize(n);
+    }
+
+    GroundTrackGenerator::GroundTrackGenerator(double maxAngle, size_t batchSize, double unitToMeter)
+        :m_maxAngle(maxAngle * PI / 180.0)
+        , m_cosMaxAngle(cos(maxAngle * PI / 180.0))
+        , m_batchSize(batchSize > 0 ? batchSize : 1)
+        , m_unitToMeter(unitToMeter)
+        , m_bHasLast(false)
+        , m_lastJD(0.0)
+        , m_lastX(0.0)
+        , m_lastY(0.0)
+        , m_lastZ(0.0)
+    {
+        m_coarse.resize(m_batchSize);
+        m_refine.resize(MAX_REFINE);
+    }
+
+    bool GroundTrackGenerator::convert(const OrbitModel& model, Buffer& buffer, size_t n)
+    {
+        if (!model.propagate(&buffer.jd[0], n, &buffer.data[0]))
+        {
+            return false;
+        }
+        for (size_t i = 0; i < n; ++i)
+        {
+            buffer.x[i] = buffer.data[i].position.x() * m_unitToMeter;
+            buffer.y[i] = buffer.data[i].position.y() * m_unitToMeter;
+            buffer.z[i] = buffer.data[i].position.z() * m_unitToMeter;
+        }
+        oatCoord::temeToEcef(n, &buffer.jd[0], &buffer.x[0], &buffer.y[0], &buffer.z[0], &buffer.x[0], &buffer.y[0], &buffer.z[0]);
+        oatCoord::ecefToGeodetic(n, &buffer.x[0], &buffer.y[0], &buffer.z[0], &buffer.lon[0], &buffer.lat[0], &buffer.alt[0]);
+        return true;
+    }
+
+    void GroundTrackGenerator::emit(GroundTrack& track, double lon, double lat, double jd, bool bNewSegment)
+    {
+        if (bNewSegment)
+        {
+            track.segments.push_back(track.lon.size());
+        }
+        else if (fabs(lon - track.lon.back()) > 90.0)
+        {
+            // only close to a pole: go along the pole edge of the map instead of across it
+            double pole = lat + track.lat.back() > 0.0 ? 90.0 : -90.0;
+            double poleJD = 0.5 * (jd + track.jd.back());
+            double prevLon = track.lon.back();
+            track.lon.push_back(prevLon);
+            track.lat.push_back(pole);
+            track.jd.push_back(poleJD);
+            track.lon.push_back(lon);
+            track.lat.push_back(pole);
+            track.jd.push_back(poleJD);
+        }
+        track.lon.push_back(lon);
+        track.lat.push_back(lat);
+        track.jd.push_back(jd);
+    }
+
+    void GroundTrackGenerator::append(const Buffer& buffer, size_t i, GroundTrack& track)
+    {
+        const double x = buffer.x[i], y = buffer.y[i], z = buffer.z[i];
+        const double jd = buffer.jd[i];
+        double lon = buffer.lon[i];
+        // a point on the antimeridian belongs to the east side, keep it at +180
+        if (lon <= -180.0 && !(y < 0.0))
+        {
+            lon = 180.0;
+        }
+
+        bool bNewSegment = !m_bHasLast;
+        if (m_bHasLast && (m_lastY < 0.0) != (y < 0.0))
+        {
+            // the chord crosses the x-z plane, on the antimeridian half of it if x < 0 there
+            double t = m_lastY / (m_lastY - y);
+            double cx = m_lastX + t * (x - m_lastX);
+            if (cx < 0.0)
+            {
+                double cy = 0.0;
+                double cz = m_lastZ + t * (z - m_lastZ);
+                double clon, clat, calt;
+                oatCoord::ecefToGeodetic(1, &cx, &cy, &cz, &clon, &clat, &calt);
+                double cjd = m_lastJD + t * (jd - m_lastJD);
+                double side = m_lastY < 0.0 ? -180.0 : 180.0;
+
+                emit(track, side, clat, cjd, false);
+                emit(track, -side, clat, cjd, true);
+            }
+        }
+        emit(track, lon, buffer.lat[i], jd, bNewSegment);
+
+        m_bHasLast = true;
+        m_lastJD = jd;
+        m_lastX = x;
+        m_lastY = y;
+        m_lastZ = z;
+    }
+
+    bool GroundTrackGenerator::generate(const OrbitModel& model, double beginJD, double endJD, double dDeltaTime, GroundTrack& track)
+    {
+        track.clear();
+        m_bHasLast = false;
+        if (dDeltaTime <= 0.0 || endJD < beginJD)
+        {
+            return true;
+        }
+
+        // same grid as EphemerisGenerator, the last sample not after endJD
+        const size_t sampleNum = (size_t)floor((endJD - beginJD) / dDeltaTime + 1e-9) + 1;
+        for (size_t begin = 0; begin < sampleNum; begin += m_batchSize)
+        {
+            const size_t n = sampleNum - begin < m_batchSize ? sampleNum - begin : m_batchSize;
+            for (size_t i = 0; i < n; ++i)
+            {
+                m_coarse.jd[i] = beginJD + (double)(begin + i) * dDeltaTime;
+            }
+            if (!convert(model, m_coarse, n))
+            {
+                return false;
+            }
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (m_bHasLast)
+                {
+                    const double x = m_coarse.x[i], y = m_coarse.y[i], z = m_coarse.z[i];
+                    double dot = m_lastX * x + m_lastY * y + m_lastZ * z;
+                    double norm2 = (m_lastX * m_lastX + m_lastY * m_lastY + m_lastZ * m_lastZ) * (x * x + y * y + z * z);
+                    double cosAngle = dot / sqrt(norm2);
+                    if (cosAngle < m_cosMaxAngle)
+                    {
+                        // evenly spaced extra samples bring the gap below maxAngle
+                        double angle = acos(cosAngle < -1.0 ? -1.0 : cosAngle);
+                        size_t k = (size_t)ceil(angle / m_maxAngle);
+                        k = k < MAX_REFINE ? k : MAX_REFINE;
+                        const double gapBegin = m_lastJD;
+                        const double gapStep = (m_coarse.jd[i] - gapBegin) / (double)k;
+                        for (size_t j = 1; j < k; ++j)
+                        {
+                            m_refine.jd[j - 1] = gapBegin + (double)j * gapStep;
+                        }
+                        if (k > 1)
+                        {
+                            if (!convert(model, m_refine, k - 1))
+                            {
+                                return false;
+                            }
+                            for (size_t j = 0; j + 1 < k; ++j)
+                            {
+                                append(m_refine, j, track);
+                            }
+                        }
+                    }
+                }
+                append(m_coarse, i, track);
+            }
+        }
+        return true;
+    }
+}
@@ -1,13 +1,51 @@
 #include "./oat_physics_const.h"
 #include "./orbitmodel.h"
+#include "./orbitattitude.h"
+#include <algorithm>
 
 namespace oat
 {
-    OrbitModel::OrbitModel()
+    namespace
+    {
+        template <typename T>
+        size_t sampleIntoImpl(OrbitModel& model, double curJD, int ptNum, T* xyz, const Vec3& origin)
+        {
+            // fixed size chunks on the stack keep the call allocation free
+            const int CHUNK = 64;
+            double jd[CHUNK];
+            double pos[CHUNK * 3];
+
+            double dDT = model.getPeriod() / (double)ptNum;
+            int begin = -ptNum / 2;
+            int end = ptNum / 2;
+            size_t count = 0;
+            for (int i = begin; i < end; i += CHUNK)
+            {
+                int n = end - i < CHUNK ? end - i : CHUNK;
+                for (int k = 0; k < n; ++k)
+                {
+                    jd[k] = (i + k) * dDT + curJD;
+                }
+                model.positionsAtJD(jd, n, pos);
+                for (int k = 0; k < n * 3; k += 3)
+                {
+                    xyz[count * 3] = (T)(pos[k] * phy_kmToSimUnit - origin._v[0]);
+                    xyz[count * 3 + 1] = (T)(pos[k + 1] * phy_kmToSimUnit - origin._v[1]);
+                    xyz[count * 3 + 2] = (T)(pos[k + 2] * phy_kmToSimUnit - origin._v[2]);
+                    ++count;
+                }
+            }
+            return count;
+        }
+    }
+
+    OrbitModel::OrbitModel(MemoryArena* arena)
     	:m_period(0.0)
 		, m_boundingRadius(0.0)
 		, m_beginTime(0.0)
 		, m_endTime(0.0)
+		, orbitData(ArenaAllocator<OrbitData>(arena))
+		, m_attitudeLaw(NULL)
     {
 
     }
@@ -29,9 +67,80 @@ namespace oat
 
     Quat OrbitModel::quatAtJD(double jd)
     {
+        if (m_attitudeLaw != NULL)
+        {
+            return m_attitudeLaw->attitude(jd, positionAtJD(jd), velocityAtJD(jd));
+        }
         return Quat(0,0,0,0);
     }
 
+    void OrbitModel::positionsAtJD(const double* jd, size_t n, double* x, double* y, double* z, size_t stride)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            Vec3 v = positionAtJD(jd[i]);
+            x[i * stride] = v.x();
+            y[i * stride] = v.y();
+            z[i * stride] = v.z();
+        }
+    }
+
+    void OrbitModel::velocitiesAtJD(const double* jd, size_t n, double* x, double* y, double* z, size_t stride)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            Vec3 v = velocityAtJD(jd[i]);
+            x[i * stride] = v.x();
+            y[i * stride] = v.y();
+            z[i * stride] = v.z();
+        }
+    }
+
+    bool OrbitModel::propagate(const double* /*jd*/, size_t /*n*/, OrbitData* /*out*/) const
+    {
+        return false;
+    }
+
+    bool OrbitModel::propagate(const JulianDate* jd, size_t n, OrbitData* out) const
+    {
+        double block[64];
+        for (size_t begin = 0; begin < n; begin += 64)
+        {
+            size_t m = n - begin < 64 ? n - begin : 64;
+            for (size_t i = 0; i < m; ++i)
+            {
+                block[i] = jd[begin + i].jd();
+            }
+            if (!propagate(block, m, out + begin))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<OrbitData> OrbitModel::getOrbitData() const
+    {
+        const OrbitDataVector& data = getOrbitCache();
+        return std::vector<OrbitData>(data.begin(), data.end());
+    }
+
+    OrbitDataView OrbitModel::getOrbitDataView(double beginJD, double endJD) const
+    {
+        struct ByJD {
+            bool operator () (const OrbitData& data, double jd) const {return data.jd < jd;}
+            bool operator () (double jd, const OrbitData& data) const {return jd < data.jd;}
+        };
+        const OrbitDataVector& data = getOrbitCache();
+        OrbitDataVector::const_iterator first = std::lower_bound(data.begin(), data.end(), beginJD, ByJD());
+        OrbitDataVector::const_iterator last = std::upper_bound(first, data.end(), endJD, ByJD());
+        if (first >= last)
+        {
+            return OrbitDataView();
+        }
+        return OrbitDataView(&*first, last - first);
+    }
+
     void OrbitModel::sample(double curJD, int ptNum, std::map<double, Vec3>& mapTime2Position)
     {
 		double dDT = getPeriod() / (double)ptNum;
@@ -41,4 +150,108 @@ namespace oat
 			mapTime2Position[dJD] = positionAtJD(dJD) * phy_kmToSimUnit;
 		}
     }
+
+    size_t OrbitModel::sampleInto(double curJD, int ptNum, double* xyz, const Vec3& origin)
+    {
+        return sampleIntoImpl(*this, curJD, ptNum, xyz, origin);
+    }
+
+    size_t OrbitModel::sampleInto(double curJD, int ptNum, float* xyz, const Vec3& origin)
+    {
+        return sampleIntoImpl(*this, curJD, ptNum, xyz, origin);
+    }
+
+    size_t OrbitModel::sampleAdaptive(double beginJD, double endJD, const SampleTolerance& tolerance,
+                                      double* xyz, double* jd, size_t capacity, const Vec3& origin)
+    {
+        // a few seed segments keep every arc well below half a turn before the error test
+        const int SEED_NUM = 4;
+        const int MAX_DEPTH = 16;
+        const int MAX_SPLIT = 32;
+        struct Node {
+            double jd;
+            Vec3 position;
+        };
+
+        if (capacity == 0 || endJD <= beginJD)
+        {
+            return 0;
+        }
+
+        const double dMaxError = tolerance.pixelError * tolerance.cameraDistance * tolerance.pixelAngle;
+        const double dMinCos = cos(tolerance.maxTurnAngle);
+        size_t count = 0;
+
+        Node cur;
+        cur.jd = beginJD;
+        cur.position = positionAtJD(beginJD) * phy_kmToSimUnit;
+        if (jd) jd[count] = cur.jd;
+        Vec3 v = cur.position - origin;
+        xyz[0] = v.x(); xyz[1] = v.y(); xyz[2] = v.z();
+        ++count;
+
+        for (int seed = 1; seed <= SEED_NUM && count < capacity; ++seed)
+        {
+            // pending segment ends, the top one is the closest to cur
+            Node stack[MAX_DEPTH * (MAX_SPLIT - 1) + 1];
+            int depth[MAX_DEPTH * (MAX_SPLIT - 1) + 1];
+            int top = 0;
+            stack[0].jd = seed == SEED_NUM ? endJD : beginJD + (endJD - beginJD) * seed / SEED_NUM;
+            stack[0].position = positionAtJD(stack[0].jd) * phy_kmToSimUnit;
+            depth[0] = 0;
+
+            while (top >= 0 && count < capacity)
+            {
+                const Node end = stack[top];
+                int split = 1;
+                if (depth[top] < MAX_DEPTH)
+                {
+                    Vec3 mid = positionAtJD(0.5 * (cur.jd + end.jd)) * phy_kmToSimUnit;
+
+                    // distance of the true mid point to the chord
+                    Vec3 chord = end.position - cur.position;
+                    Vec3 offset = mid - cur.position;
+                    double len2 = chord.length2();
+                    double dError = len2 > 0.0 ? (offset ^ chord).length() / sqrt(len2) : offset.length();
+
+                    // angle swept by the segment seen from the frame origin (the orbit focus)
+                    double r2 = cur.position.length2() * end.position.length2();
+                    bool bTurn = r2 > 0.0 && (cur.position * end.position) < dMinCos * sqrt(r2);
+
+                    if (dError > dMaxError)
+                    {
+                        // chord error falls with the square of the segment length, cut straight
+                        // into the number of pieces that should pass (small margin for the curve)
+                        split = (int)ceil(1.05 * sqrt(dError / dMaxError));
+                        split = split > MAX_SPLIT ? MAX_SPLIT : split;
+                    }
+                    split = bTurn && split < 2 ? 2 : split;
+                }
+
+                if (split > 1)
+                {
+                    // push the inner points far to near so the nearest ends on top
+                    int d = depth[top] + 1;
+                    for (int k = split - 1; k >= 1; --k)
+                    {
+                        ++top;
+                        stack[top].jd = cur.jd + (end.jd - cur.jd) * k / split;
+                        stack[top].position = positionAtJD(stack[top].jd) * phy_kmToSimUnit;
+                        depth[top] = d;
+                    }
+                    continue;
+                }
+
+                cur = end;
+                --top;
+                if (jd) jd[count] = cur.jd;
+                v = cur.position - origin;
+                xyz[count * 3] = v.x();
+                xyz[count * 3 + 1] = v.y();
+                xyz[count * 3 + 2] = v.z();
+                ++count;
+            }
+        }
+        return count;
+    }
 }
\ No newline at end of file
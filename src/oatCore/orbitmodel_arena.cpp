@@ -0,0 +1,25 @@
+#include "orbitmodel_arena.h"
+
+namespace oat
+{
+    OrbitModelArena::OrbitModelArena(size_t slabSize)
+        :m_memory(slabSize)
+    {
+
+    }
+
+    OrbitModelArena::~OrbitModelArena()
+    {
+        clear();
+    }
+
+    void OrbitModelArena::clear()
+    {
+        for (size_t i = m_models.size(); i > 0; --i)
+        {
+            m_models[i - 1]->~OrbitModel();
+        }
+        m_models.clear();
+        m_memory.release();
+    }
+}
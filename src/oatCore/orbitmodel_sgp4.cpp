@@ -1,10 +1,25 @@
 #include "SGP4.h"
 #include "orbitmodel_sgp4.h"
 #include "oat_math_const.h"
+#include "orbitattitude.h"
+#include "orbitephemeris_cache.h"
 #include <stdio.h>
+#include <string.h>
 
 namespace oat
 {
+    namespace
+    {
+        // TLE line as a cache key, line breaks and trailing blanks do not make a different element set
+        std::string tleLineKey(const char* line)
+        {
+            std::string key(line, strnlen(line, 130));
+            size_t last = key.find_last_not_of(" \t\r\n");
+            key.erase(last == std::string::npos ? 0 : last + 1);
+            return key;
+        }
+    }
+
     OrbitModel_SGP4::OrbitModel_SGP4(const char *cTleLine1st,
                                      const char *cTleLine2nd,
                                      double dBeginTime,
@@ -13,206 +28,432 @@ namespace oat
                                      char opsmode,
                                      char typerun,
                                      char typeinput)
+        :OrbitModel_SGP4(NULL, cTleLine1st, cTleLine2nd, dBeginTime, dEndTime, dDeltaTime, opsmode, typerun, typeinput)
     {
-        float period = 0.0f;
-        // sccanf period
-        sscanf(cTleLine1st, "%*s %*s %*s %*s %*s %*s %*s %*s %f", &period);
+    }
 
+    OrbitModel_SGP4::OrbitModel_SGP4(MemoryArena* arena,
+                                     const char *cTleLine1st,
+                                     const char *cTleLine2nd,
+                                     double dBeginTime,
+                                     double dEndTime,
+                                     double dDeltaTime,
+                                     char opsmode,
+                                     char typerun,
+                                     char typeinput)
+        :OrbitModel(arena)
+        , m_deltaTime(dDeltaTime)
+        , m_maxExtendTime(0.0)
+        , m_perigeeRadius(0.0)
+        , m_apogeeRadius(0.0)
+    {
         char longstr1[130], longstr2[130];
-        strncpy(longstr1, cTleLine1st, 130);
-        strncpy(longstr2, cTleLine2nd, 130);
-
-        char str[2];
-        double ro[3];
-        double vo[3];
-
-        double p, a, ecc, incl, node, argp, nu, m, arglat, truelon, lonper;
-        double sec, jd, jdFrac, rad, tsince, startmfe, stopmfe, deltamin;
-        int year;
-        int mon;
-        int day;
-        int hr;
-        int min;
-        typedef char str3[4];
-        // month string
-        char monstr[13][4] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
-                              "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
-        //str3 monstr[13];
-        char outname[64];
-        elsetrec satrec;
-
-        rad = 180.0 / PI;
-
-        printf("%s\n", SGP4Version);
+        strncpy(longstr1, cTleLine1st, 129);
+        strncpy(longstr2, cTleLine2nd, 129);
+        longstr1[129] = longstr2[129] = '\0';
+
+        double startmfe, stopmfe, deltamin;
 
         m_opsmode = opsmode;
         m_typerun = typerun;
         m_typeinput = typeinput;
-        
 
         gravconsttype whichconst = wgs84;
 
-        satrec.classification = 'U';
-        strncpy_s(satrec.intldesg, "          ", 11 * sizeof(char));
-        satrec.ephtype = 0;
-        satrec.elnum = 0;
-        satrec.revnum = 0;
+        m_beginTime = dBeginTime;
+        m_endTime = dEndTime;
+        resetCacheStats();
+
+        m_satrec.classification = 'U';
+        strncpy_s(m_satrec.intldesg, "          ", 11 * sizeof(char));
+        m_satrec.ephtype = 0;
+        m_satrec.elnum = 0;
+        m_satrec.revnum = 0;
         
         SGP4Funcs::twoline2rv(longstr1, longstr2, m_typerun, m_typeinput, m_opsmode, whichconst,
-                              startmfe, stopmfe, deltamin, satrec);
-
-        tsince = (dBeginTime - satrec.jdsatepoch) * 1440.0; // JD Convert to minutes
-        while (tsince <= (dEndTime - satrec.jdsatepoch) * 1440.0)
+                              startmfe, stopmfe, deltamin, m_satrec);
+
+        // orbit metrics from the initialized elements: no_unkozai in rad/min, a in earth radii
+        m_period = 2.0 * PI / m_satrec.no_unkozai / 1440.0;
+        m_perigeeRadius = m_satrec.a * (1.0 - m_satrec.ecco) * m_satrec.radiusearthkm;
+        m_apogeeRadius = m_satrec.a * (1.0 + m_satrec.ecco) * m_satrec.radiusearthkm;
+        m_boundingRadius = m_apogeeRadius;
+
+        // identical models share one immutable ephemeris block, see EphemerisCache
+        EphemerisCache& sharedCache = EphemerisCache::instance();
+        EphemerisKey key;
+        bool bShared = sharedCache.getEnabled();
+        if (bShared)
         {
-            double r[3], v[3];
-            SGP4Funcs::sgp4(satrec, tsince, r, v);
-            // save result
-            OrbitData data;
-            data.jd = satrec.jdsatepoch + tsince / 1440.0;
-            data.position = Vec3(r[0], r[1], r[2]);
-            data.velocity = Vec3(v[0], v[1], v[2]);
-
-            orbitData.push_back(data);
-            //打印data
-            //把JD转换成年月日时分秒
-            double jd = data.jd;
-            double jdFrac = jd - floor(jd);
-            SGP4Funcs::invjday_SGP4(jd, jdFrac, year, mon, day, hr, min, sec);
-
-            //打印data.jd
-            //printf("jd: %f\n", jd);
-            //打印年月日时分秒与相应的data数据
-            //printf("%4d %2d %2d %2d %2d %8.6f %14.6f %14.6f %14.6f %14.6f %14.6f\n",
-            //    				year, mon, day, hr, min, sec, data.position.x(), data.position.y(), data.position.z(), data.velocity.x(), data.velocity.y(), data.velocity.z());
-            
-
-            tsince += dDeltaTime * 1440.0; // add step
+            key.tleLine1st = tleLineKey(cTleLine1st);
+            key.tleLine2nd = tleLineKey(cTleLine2nd);
+            key.beginTime = dBeginTime;
+            key.endTime = dEndTime;
+            key.deltaTime = dDeltaTime;
+            key.opsmode = m_opsmode;
+            key.gravity = (int)whichconst;
+            m_sharedCache = sharedCache.find(key);
         }
 
+        if (!m_sharedCache)
+        {
+            // sample i from its index and the two part epoch, no step is accumulated; same grid as
+            // EphemerisGenerator, the last sample not after dEndTime
+            const JulianDate epoch = getEpoch();
+            const JulianDate begin(dBeginTime);
+            size_t sampleNum = 0;
+            if (dDeltaTime > 0.0 && dEndTime >= dBeginTime)
+            {
+                sampleNum = (size_t)floor((dEndTime - dBeginTime) / dDeltaTime + 1e-9) + 1;
+            }
+            orbitData.reserve(sampleNum);
+            for (size_t i = 0; i < sampleNum; ++i)
+            {
+                const JulianDate t = begin + (double)i * dDeltaTime;
+                double tsince = (t - epoch) * 1440.0; // JD Convert to minutes
+                double r[3], v[3];
+                SGP4Funcs::sgp4(m_satrec, tsince, r, v);
+                // save result
+                OrbitData data;
+                data.jd = t.jd();
+                data.position = Vec3(r[0], r[1], r[2]);
+                data.velocity = Vec3(v[0], v[1], v[2]);
+
+                orbitData.push_back(data);
+            }
+            if (bShared)
+            {
+                m_sharedCache = sharedCache.insert(key, orbitData);
+            }
+        }
+        const OrbitDataVector& cached = cache();
+        if (!cached.empty())
+        {
+            growBoundingRadius(&cached[0], cached.size());
+        }
+    }
 
-        int ttt = 0;
-
-        /*SGP4Funcs::sgp4(satrec, 0.0, ro, vo);
+    OrbitModel_SGP4::~OrbitModel_SGP4()
+    {
+    }
 
-        double rteme[3];
-        double vteme[3];
-        double ateme[3];
+    Vec3 OrbitModel_SGP4::positionAtJD(double jd)
+    {
+        // check jd is in precalc range
+        if (!inCache(jd) && !extendCache(jd))
+        {
+            // if not in range run sgp4 directly
+            return directState(jd).position;
+        }
+        ++m_cacheStats.hits;
 
-        double rpef[3];
-        double vpef[3];
-        double apef[3];
+        // find data in orbitData and interpolation(if needed)
+        const OrbitDataVector& cached = cache();
+        size_t i;
+        double factor;
+        locate(jd, i, factor);
+        // Linear interpolation
+        return Vec3(
+            cached[i].position.x() + factor * (cached[i + 1].position.x() - cached[i].position.x()),
+            cached[i].position.y() + factor * (cached[i + 1].position.y() - cached[i].position.y()),
+            cached[i].position.z() + factor * (cached[i + 1].position.z() - cached[i].position.z()));
+    }
 
-        for (int i = 0; i < 3; i++)
+    Vec3 OrbitModel_SGP4::velocityAtJD(double jd)
+    {
+        // check jd is in precalc range
+        if (!inCache(jd) && !extendCache(jd))
         {
-            rteme[i] = ro[i];
-            vteme[i] = vo[i];
+            // if not in range run sgp4 directly
+            return directState(jd).velocity;
         }
+        ++m_cacheStats.hits;
+
+        // find data in orbitData and interpolation(if needed)
+        const OrbitDataVector& cached = cache();
+        size_t i;
+        double factor;
+        locate(jd, i, factor);
+        // Linear interpolation
+        return Vec3(
+            cached[i].velocity.x() + factor * (cached[i + 1].velocity.x() - cached[i].velocity.x()),
+            cached[i].velocity.y() + factor * (cached[i + 1].velocity.y() - cached[i].velocity.y()),
+            cached[i].velocity.z() + factor * (cached[i + 1].velocity.z() - cached[i].velocity.z()));
+    }
 
-        // calculate ateme
-        double ateme_unit_vector[3];
-        double magnitude_of_rteme = sqrt(pow(rteme[0], 2) + pow(rteme[1], 2) + pow(rteme[2], 2));
-        for (int i = 0; i < 3; i++)
+    Quat OrbitModel_SGP4::quatAtJD(double jd)
+    {
+        if (m_attitudeLaw != NULL)
         {
-            ateme_unit_vector[i] = -1 * rteme[i] / magnitude_of_rteme;
-            ateme[i] = 9.81 * ateme_unit_vector[i];
+            Vec3 position, velocity;
+            stateAtJD(jd, position, velocity);
+            return m_attitudeLaw->attitude(jd, position, velocity);
         }
+        return Quat();
+    }
 
-        jd = satrec.jdsatepoch;
-        jdFrac = satrec.jdsatepochF;
-        SGP4Funcs::invjday_SGP4(jd, jdFrac, year, mon, day, hr, min, sec);
-        // delta UT1 = UT1 - UTC; on 9/12/2016 delta UT1 = -0.3811866 seconds
-        // UTC = UT1 - delta UT1 => UT1 = UTC + delta UT1
-        double day_jdut1 = (jd + jdFrac + (-0.3811899)) / 86400;
-        double jdut1 = (day_jdut1 - 2451545) / 36525;*/
+    void OrbitModel_SGP4::setCacheExtension(double dMaxExtendTime)
+    {
+        m_maxExtendTime = dMaxExtendTime;
+    }
+
+    void OrbitModel_SGP4::resetCacheStats()
+    {
+        m_cacheStats.hits = 0;
+        m_cacheStats.fallbacks = 0;
+        m_cacheStats.extendedSamples = 0;
+        m_cacheStats.failures = 0;
+    }
 
+    void OrbitModel_SGP4::stateAtJD(double jd, Vec3& position, Vec3& velocity)
+    {
+        if (!inCache(jd) && !extendCache(jd))
+        {
+            OrbitData data = directState(jd);
+            position = data.position;
+            velocity = data.velocity;
+            return;
+        }
+        ++m_cacheStats.hits;
+
+        size_t i;
+        double factor;
+        locate(jd, i, factor);
+        const OrbitData& d0 = cache()[i];
+        const OrbitData& d1 = cache()[i + 1];
+        position = d0.position + (d1.position - d0.position) * factor;
+        velocity = d0.velocity + (d1.velocity - d0.velocity) * factor;
+    }
 
+    void OrbitModel_SGP4::positionsAtJD(const double* jd, size_t n, double* x, double* y, double* z, size_t stride)
+    {
+        batchAtJD(jd, n, &OrbitData::position, x, y, z, stride);
+    }
 
+    void OrbitModel_SGP4::velocitiesAtJD(const double* jd, size_t n, double* x, double* y, double* z, size_t stride)
+    {
+        batchAtJD(jd, n, &OrbitData::velocity, x, y, z, stride);
+    }
 
-        /*// init SGP4
-        double startmfe, stopmfe, deltamin;
-        elsetrec satrec;
-        gravconsttype whichconst;
-        // Make sure TLE Data right
-        SGP4Funcs::twoline2rv(longstr1, longstr2, 'i', 'e', 'a', whichconst, startmfe, stopmfe, deltamin, satrec);
+    void OrbitModel_SGP4::batchAtJD(const double* jd, size_t n, Vec3 OrbitData::* member,
+                                    double* x, double* y, double* z, size_t stride)
+    {
+        const size_t CHUNK = 64;
+        const size_t OUT_OF_CACHE = (size_t)-1;
+        size_t index[CHUNK];
 
-        // pre calc track
-        double tsince = (dBeginTime - satrec.jdsatepoch) * 1440.0; // JD Convert to minutes
-        while (tsince <= (dEndTime - satrec.jdsatepoch) * 1440.0)
+        for (size_t base = 0; base < n; base += CHUNK)
         {
-            double r[3], v[3];
-            SGP4Funcs::sgp4(satrec, tsince, r, v);
-            // save result
-            OrbitData data;
-            data.jd = satrec.jdsatepoch + tsince / 1440.0;
-            data.position = Vec3(r[0], r[1], r[2]);
-            data.velocity = Vec3(v[0], v[1], v[2]);
+            const size_t count = n - base < CHUNK ? n - base : CHUNK;
+            const double* t = jd + base;
 
-            orbitData.push_back(data);
+            // extension may reallocate the cache, finish it before locating any sample
+            size_t outside = 0;
+            for (size_t k = 0; k < count; ++k)
+            {
+                outside += inCache(t[k]) ? 0 : 1;
+            }
+            for (size_t k = 0; k < count && outside > 0; ++k)
+            {
+                index[k] = (inCache(t[k]) || extendCache(t[k])) ? 0 : OUT_OF_CACHE;
+            }
 
-            tsince += dDeltaTime * 1440.0; // add step
-        }*/
+            const OrbitDataVector& cached = cache();
+            if (cached.size() < 2)
+            {
+                // no interval to interpolate in (empty span or step), the whole chunk runs sgp4
+                for (size_t k = 0; k < count; ++k)
+                {
+                    const size_t o = (base + k) * stride;
+                    Vec3 v = directState(t[k]).*member;
+                    x[o] = v.x();
+                    y[o] = v.y();
+                    z[o] = v.z();
+                }
+                continue;
+            }
+            const OrbitData* data = &cached[0];
+            const size_t last = cached.size() - 2;
+            const double jd0 = data[0].jd;
+            const double invStep = 1.0 / m_deltaTime;
+            size_t hits = 0;
+            for (size_t k = 0; k < count; ++k)
+            {
+                const size_t o = (base + k) * stride;
+                if (outside > 0 && index[k] == OUT_OF_CACHE)
+                {
+                    Vec3 v = directState(t[k]).*member;
+                    x[o] = v.x();
+                    y[o] = v.y();
+                    z[o] = v.z();
+                    continue;
+                }
+                // same lookup as locate(), the grid guess is almost always right
+                double g = (t[k] - jd0) * invStep;
+                size_t i = g <= 0.0 ? 0 : (size_t)g;
+                i = i > last ? last : i;
+                if (t[k] < data[i].jd || t[k] > data[i + 1].jd)
+                {
+                    double f;
+                    locate(t[k], i, f);
+                }
+                const OrbitData& d0 = data[i];
+                const OrbitData& d1 = data[i + 1];
+                const double f = (t[k] - d0.jd) / (d1.jd - d0.jd);
+                const Vec3& a = d0.*member;
+                const Vec3& b = d1.*member;
+                x[o] = a._v[0] + f * (b._v[0] - a._v[0]);
+                y[o] = a._v[1] + f * (b._v[1] - a._v[1]);
+                z[o] = a._v[2] + f * (b._v[2] - a._v[2]);
+                ++hits;
+            }
+            m_cacheStats.hits += hits;
+        }
     }
 
-    OrbitModel_SGP4::~OrbitModel_SGP4()
+    bool OrbitModel_SGP4::inCache(double jd) const
     {
+        const OrbitDataVector& cached = cache();
+        return cached.size() > 1 && jd >= cached.front().jd && jd <= cached.back().jd;
     }
 
-    Vec3 OrbitModel_SGP4::positionAtJD(double jd)
+    void OrbitModel_SGP4::locate(double jd, size_t& i, double& factor) const
     {
-        // check jd is in precalc range
-        if (orbitData.empty() || jd < orbitData.front().jd || jd > orbitData.back().jd)
+        // the cache is on a fixed step grid, jump to the interval instead of searching
+        const OrbitDataVector& cached = cache();
+        const size_t last = cached.size() - 2;
+        double t = (jd - cached.front().jd) / m_deltaTime;
+        i = t <= 0.0 ? 0 : (size_t)t;
+        if (i > last)
+        {
+            i = last;
+        }
+        // sample times carry rounding, step to the interval really holding jd
+        while (i > 0 && jd < cached[i].jd)
+        {
+            --i;
+        }
+        while (i < last && jd > cached[i + 1].jd)
         {
-            // if not in range return zero
-            return Vec3();
+            ++i;
         }
+        factor = (jd - cached[i].jd) / (cached[i + 1].jd - cached[i].jd);
+    }
 
-        // find data in orbitData and interpolation(if needed)
-        for (size_t i = 0; i < orbitData.size() - 1; ++i)
+    bool OrbitModel_SGP4::extendCache(double jd)
+    {
+        const OrbitDataVector& cached = cache();
+        if (cached.empty() || m_maxExtendTime <= 0.0 || m_deltaTime <= 0.0)
         {
-            if (jd >= orbitData[i].jd && jd <= orbitData[i + 1].jd)
-            {
-                // Linear interpolation
-                double factor = (jd - orbitData[i].jd) / (orbitData[i + 1].jd - orbitData[i].jd);
-                return Vec3(
-                    orbitData[i].position.x() + factor * (orbitData[i + 1].position.x() - orbitData[i].position.x()),
-                    orbitData[i].position.y() + factor * (orbitData[i + 1].position.y() - orbitData[i].position.y()),
-                    orbitData[i].position.z() + factor * (orbitData[i + 1].position.z() - orbitData[i].position.z()));
-            }
+            return false;
+        }
+
+        bool bForward = jd > cached.back().jd;
+        double dEdgeJD = bForward ? cached.back().jd : cached.front().jd;
+        double dGap = bForward ? jd - dEdgeJD : dEdgeJD - jd;
+        if (dGap > m_maxExtendTime)
+        {
+            return false;
+        }
+
+        // keep the samples on the grid of the existing cache, tolerate rounding of a query meant to
+        // be on the grid (it may then lie a few microseconds past the new edge)
+        size_t count = (size_t)ceil(dGap / m_deltaTime - 1e-6);
+        if (count == 0)
+        {
+            count = 1;
+        }
+        std::vector<double> jds(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            // ascending time in both directions
+            jds[i] = bForward ? dEdgeJD + (i + 1) * m_deltaTime : dEdgeJD - (count - i) * m_deltaTime;
+        }
+        std::vector<OrbitData> samples(count);
+        if (!propagate(&jds[0], count, &samples[0]))
+        {
+            return false;
         }
 
-        // if can't find point, return nearest point
-        return orbitData.back().position;
+        if (m_sharedCache)
+        {
+            // the shared block is immutable, grow a private copy
+            orbitData.assign(m_sharedCache->begin(), m_sharedCache->end());
+            m_sharedCache.reset();
+        }
+        if (bForward)
+        {
+            orbitData.insert(orbitData.end(), samples.begin(), samples.end());
+            m_endTime = orbitData.back().jd;
+        }
+        else
+        {
+            orbitData.insert(orbitData.begin(), samples.begin(), samples.end());
+            m_beginTime = orbitData.front().jd;
+        }
+        growBoundingRadius(&samples[0], count);
+        m_cacheStats.extendedSamples += count;
+        return true;
     }
 
-    Vec3 OrbitModel_SGP4::velocityAtJD(double jd)
+    OrbitData OrbitModel_SGP4::directState(double jd)
     {
-        // check jd is in precalc range
-        if (orbitData.empty() || jd < orbitData.front().jd || jd > orbitData.back().jd)
+        ++m_cacheStats.fallbacks;
+        OrbitData data;
+        if (!propagate(&jd, 1, &data))
         {
-            // if not in range return zero
-            return Vec3();
+            // whatever sgp4 left is meaningless, answer like OrbitModel::positionAtJD
+            ++m_cacheStats.failures;
+            data.position = Vec3(0, 0, 0);
+            data.velocity = Vec3(0, 0, 0);
         }
+        return data;
+    }
 
-        // find data in orbitData and interpolation(if needed)
-        for (size_t i = 0; i < orbitData.size() - 1; ++i)
+    void OrbitModel_SGP4::growBoundingRadius(const OrbitData* data, size_t n)
+    {
+        double r2 = m_boundingRadius * m_boundingRadius;
+        for (size_t i = 0; i < n; ++i)
         {
-            if (jd >= orbitData[i].jd && jd <= orbitData[i + 1].jd)
-            {
-                // Linear interpolation
-                double factor = (jd - orbitData[i].jd) / (orbitData[i + 1].jd - orbitData[i].jd);
-                return Vec3(
-                    orbitData[i].velocity.x() + factor * (orbitData[i + 1].velocity.x() - orbitData[i].velocity.x()),
-                    orbitData[i].velocity.y() + factor * (orbitData[i + 1].velocity.y() - orbitData[i].velocity.y()),
-                    orbitData[i].velocity.z() + factor * (orbitData[i + 1].velocity.z() - orbitData[i].velocity.z()));
-            }
+            double d2 = data[i].position.length2();
+            r2 = d2 > r2 ? d2 : r2;
         }
+        m_boundingRadius = sqrt(r2);
+    }
 
-        //
-        return orbitData.back().velocity;
+    bool OrbitModel_SGP4::propagate(const double* jd, size_t n, OrbitData* out) const
+    {
+        // sgp4 writes into the elsetrec, work on a private copy so concurrent calls never race
+        elsetrec satrec = m_satrec;
+        // sgp4 resets satrec.error on every call, keep the first failure of the batch
+        int error = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            double r[3], v[3];
+            double tsince = ((jd[i] - satrec.jdsatepoch) - satrec.jdsatepochF) * 1440.0;
+            SGP4Funcs::sgp4(satrec, tsince, r, v);
+            error = error != 0 ? error : satrec.error;
+            out[i].jd = jd[i];
+            out[i].position = Vec3(r[0], r[1], r[2]);
+            out[i].velocity = Vec3(v[0], v[1], v[2]);
+        }
+        return error == 0;
     }
 
-    Quat OrbitModel_SGP4::quatAtJD(double jd)
+    bool OrbitModel_SGP4::propagate(const JulianDate* jd, size_t n, OrbitData* out) const
     {
-        return Quat();
+        elsetrec satrec = m_satrec;
+        const JulianDate epoch = getEpoch();
+        int error = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            double r[3], v[3];
+            SGP4Funcs::sgp4(satrec, (jd[i] - epoch) * 1440.0, r, v);
+            error = error != 0 ? error : satrec.error;
+            out[i].jd = jd[i].jd();
+            out[i].position = Vec3(r[0], r[1], r[2]);
+            out[i].velocity = Vec3(v[0], v[1], v[2]);
+        }
+        return error == 0;
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,133 @@
+#include "oat_physics_const.h"
+#include "orbitpolyline_lod.h"
+#include <algorithm>
+
+namespace oat
+{
+    namespace
+    {
+        // distance of p to the chord a-b
+        double chordDistance(const Vec3& a, const Vec3& b, const Vec3& p)
+        {
+            Vec3 chord = b - a;
+            double len2 = chord.length2();
+            if (len2 <= 0.0)
+            {
+                return (p - a).length();
+            }
+            return ((p - a) ^ chord).length() / sqrt(len2);
+        }
+    }
+
+    OrbitPolylineLOD::OrbitPolylineLOD(const OrbitModel& model, int levelNum)
+    {
+        build(model.getOrbitDataView(), levelNum);
+    }
+
+    void OrbitPolylineLOD::build(const OrbitDataView& orbitData, int levelNum)
+    {
+        m_levels.clear();
+        m_window.level = -1;
+        m_window.bReset = true;
+        m_window.first = m_window.last = 0;
+        m_window.retiredFront = m_window.retiredBack = 0;
+        m_window.appendedFront = m_window.appendedBack = 0;
+
+        const size_t n = orbitData.size;
+        if (n == 0)
+        {
+            return;
+        }
+
+        for (int k = 0; k < levelNum; ++k)
+        {
+            const size_t stride = (size_t)1 << k;
+            if (k > 0 && (n - 1) / stride < 1)
+            {
+                // coarser than a single segment
+                break;
+            }
+
+            Level level;
+            level.maxError = 0.0;
+            level.vertices.reserve((n - 1) / stride + 2);
+            level.jd.reserve((n - 1) / stride + 2);
+            size_t i = 0;
+            for (;;)
+            {
+                level.vertices.push_back(orbitData[i].position * phy_kmToSimUnit);
+                level.jd.push_back(orbitData[i].jd);
+                if (i == n - 1)
+                {
+                    break;
+                }
+                size_t next = std::min(i + stride, n - 1);
+                // skipped cache samples measure the error of the segment
+                for (size_t j = i + 1; j < next; ++j)
+                {
+                    double dError = chordDistance(orbitData[i].position, orbitData[next].position, orbitData[j].position);
+                    level.maxError = std::max(level.maxError, dError * phy_kmToSimUnit);
+                }
+                i = next;
+            }
+            // segments spanning most of a turn under-report the chord distance, keep the error monotonic
+            if (!m_levels.empty())
+            {
+                level.maxError = std::max(level.maxError, m_levels.back().maxError);
+            }
+            m_levels.push_back(level);
+        }
+    }
+
+    int OrbitPolylineLOD::selectLevel(const SampleTolerance& tolerance) const
+    {
+        const double dMaxError = tolerance.pixelError * tolerance.cameraDistance * tolerance.pixelAngle;
+        // the error grows with the level, search from the coarse end
+        for (int k = (int)m_levels.size() - 1; k > 0; --k)
+        {
+            if (m_levels[k].maxError <= dMaxError)
+            {
+                return k;
+            }
+        }
+        return 0;
+    }
+
+    const OrbitPolylineLOD::WindowDelta& OrbitPolylineLOD::update(double curJD, double trailTime, double leadTime, int level)
+    {
+        WindowDelta& w = m_window;
+        w.retiredFront = w.retiredBack = 0;
+        w.appendedFront = w.appendedBack = 0;
+        if (m_levels.empty())
+        {
+            w.bReset = false;
+            return w;
+        }
+        level = std::max(0, std::min(level, (int)m_levels.size() - 1));
+
+        // vertices inside the window, plus one on each side so the track reaches the window edges
+        const std::vector<double>& jd = m_levels[level].jd;
+        size_t first = std::lower_bound(jd.begin(), jd.end(), curJD - trailTime) - jd.begin();
+        size_t last = std::upper_bound(jd.begin(), jd.end(), curJD + leadTime) - jd.begin();
+        first = first > 0 ? first - 1 : 0;
+        last = std::min(last + 1, jd.size());
+
+        // a new level or a jump past the old window can not be patched
+        w.bReset = level != w.level || first >= w.last || last <= w.first;
+        if (!w.bReset)
+        {
+            w.retiredFront = first > w.first ? first - w.first : 0;
+            w.appendedFront = first < w.first ? w.first - first : 0;
+            w.retiredBack = last < w.last ? w.last - last : 0;
+            w.appendedBack = last > w.last ? last - w.last : 0;
+        }
+        else
+        {
+            w.appendedBack = last - first;
+        }
+        w.level = level;
+        w.first = first;
+        w.last = last;
+        return w;
+    }
+}
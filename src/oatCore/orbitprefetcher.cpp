@@ -0,0 +1,228 @@
+#include "orbitprefetcher.h"
+#include <cmath>
+
+namespace oat
+{
+    OrbitPrefetcher::OrbitPrefetcher(double dDeltaTime, int blockSize, int blockNum, unsigned int threadNum)
+        :m_deltaTime(dDeltaTime)
+        , m_blockSize(blockSize > 0 ? blockSize : 1)
+        , m_blockNum(blockNum > 2 ? blockNum : 2)
+        , m_leadTime(2.0)
+        , m_hits(0)
+        , m_misses(0)
+        , m_published(0)
+        , m_failed(0)
+        , m_pool(new ThreadPool(threadNum))
+    {
+
+    }
+
+    OrbitPrefetcher::~OrbitPrefetcher()
+    {
+        // stop the workers first, they reference the entries
+        m_pool.reset();
+
+        for (size_t i = 0; i < m_entries.size(); ++i)
+        {
+            for (int s = 0; s < m_blockNum; ++s)
+            {
+                delete m_entries[i]->slots[s].block.load();
+            }
+        }
+        for (size_t i = 0; i < m_retired.size(); ++i)
+        {
+            delete m_retired[i];
+        }
+    }
+
+    int OrbitPrefetcher::attach(OrbitModel* model)
+    {
+        std::unique_ptr<Entry> entry(new Entry);
+        entry->model = model;
+        entry->slots.reset(new Slot[m_blockNum]);
+        for (int s = 0; s < m_blockNum; ++s)
+        {
+            entry->slots[s].block.store(NULL);
+            entry->slots[s].requested.store(-1);
+        }
+        m_entries.push_back(std::move(entry));
+        return (int)m_entries.size() - 1;
+    }
+
+    long long OrbitPrefetcher::blockIndex(double jd) const
+    {
+        return (long long)floor(jd / (m_deltaTime * m_blockSize));
+    }
+
+    void OrbitPrefetcher::update(double curJD, double rate)
+    {
+        // no reader holds a block between two frames, so retired blocks can go now
+        std::vector<Block*> retired;
+        {
+            std::lock_guard<std::mutex> lock(m_retiredMutex);
+            retired.swap(m_retired);
+        }
+        for (size_t i = 0; i < retired.size(); ++i)
+        {
+            delete retired[i];
+        }
+
+        // blocks reached within the lead time, one slot stays behind the clock
+        long long curIndex = blockIndex(curJD);
+        long long leadIndex = blockIndex(curJD + rate * m_leadTime);
+        long long ahead = leadIndex > curIndex ? leadIndex - curIndex : curIndex - leadIndex;
+        if (ahead > m_blockNum - 2)
+        {
+            ahead = m_blockNum - 2;
+        }
+        long long dir = rate < 0.0 ? -1 : 1;
+
+        for (size_t e = 0; e < m_entries.size(); ++e)
+        {
+            Entry* entry = m_entries[e].get();
+            // nearest first so the current block is queued before the far ones
+            for (long long k = 0; k <= ahead; ++k)
+            {
+                request(entry, curIndex + dir * k);
+            }
+            request(entry, curIndex - dir);
+        }
+    }
+
+    void OrbitPrefetcher::request(Entry* entry, long long index)
+    {
+        Slot& slot = entry->slots[index % m_blockNum];
+        if (slot.requested.load(std::memory_order_relaxed) == index)
+        {
+            // already queued or published
+            return;
+        }
+        slot.requested.store(index, std::memory_order_release);
+        m_pool->enqueue([this, entry, index] { computeBlock(entry, index); });
+    }
+
+    void OrbitPrefetcher::computeBlock(Entry* entry, long long index)
+    {
+        Slot& slot = entry->slots[index % m_blockNum];
+        if (slot.requested.load(std::memory_order_acquire) != index)
+        {
+            // the clock moved on before this block was started
+            return;
+        }
+
+        Block* block = new Block;
+        block->index = index;
+        block->beginJD = index * (m_deltaTime * m_blockSize);
+        block->data.resize(m_blockSize + 1);
+
+        std::vector<double> jd(m_blockSize + 1);
+        for (int i = 0; i <= m_blockSize; ++i)
+        {
+            jd[i] = block->beginJD + i * m_deltaTime;
+        }
+        if (!entry->model->propagate(&jd[0], jd.size(), &block->data[0]))
+        {
+            // the slot keeps requested == index, so this block is not retried until the slot moves on
+            m_failed.fetch_add(1, std::memory_order_relaxed);
+            delete block;
+            return;
+        }
+
+        if (slot.requested.load(std::memory_order_acquire) != index)
+        {
+            delete block;
+            return;
+        }
+
+        Block* old = slot.block.exchange(block, std::memory_order_acq_rel);
+        if (slot.requested.load(std::memory_order_acquire) != index)
+        {
+            // the slot moved on between the check and the exchange and old may be the newer block,
+            // put it back unless another worker has already replaced this one
+            Block* expected = block;
+            if (slot.block.compare_exchange_strong(expected, old, std::memory_order_acq_rel))
+            {
+                old = block;
+            }
+        }
+        else
+        {
+            m_published.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (old)
+        {
+            std::lock_guard<std::mutex> lock(m_retiredMutex);
+            m_retired.push_back(old);
+        }
+    }
+
+    const OrbitPrefetcher::Block* OrbitPrefetcher::findBlock(int handle, double jd) const
+    {
+        long long index = blockIndex(jd);
+        const Slot& slot = m_entries[handle]->slots[index % m_blockNum];
+        const Block* block = slot.block.load(std::memory_order_acquire);
+        if (block == NULL || block->index != index)
+        {
+            return NULL;
+        }
+        return block;
+    }
+
+    bool OrbitPrefetcher::stateAtJD(int handle, double jd, Vec3& position, Vec3& velocity)
+    {
+        const Block* block = findBlock(handle, jd);
+        if (block == NULL)
+        {
+            ++m_misses;
+            return false;
+        }
+        ++m_hits;
+
+        double t = (jd - block->beginJD) / m_deltaTime;
+        int i = (int)t;
+        if (i < 0)
+        {
+            i = 0;
+        }
+        else if (i > m_blockSize - 1)
+        {
+            i = m_blockSize - 1;
+        }
+        double factor = t - i;
+        const OrbitData& d0 = block->data[i];
+        const OrbitData& d1 = block->data[i + 1];
+        position = d0.position + (d1.position - d0.position) * factor;
+        velocity = d0.velocity + (d1.velocity - d0.velocity) * factor;
+        return true;
+    }
+
+    Vec3 OrbitPrefetcher::positionAtJD(int handle, double jd)
+    {
+        Vec3 position, velocity;
+        if (stateAtJD(handle, jd, position, velocity))
+        {
+            return position;
+        }
+        return m_entries[handle]->model->positionAtJD(jd);
+    }
+
+    Vec3 OrbitPrefetcher::velocityAtJD(int handle, double jd)
+    {
+        Vec3 position, velocity;
+        if (stateAtJD(handle, jd, position, velocity))
+        {
+            return velocity;
+        }
+        return m_entries[handle]->model->velocityAtJD(jd);
+    }
+
+    OrbitPrefetcher::Stats OrbitPrefetcher::getStats() const
+    {
+        Stats stats;
+        stats.hits = m_hits;
+        stats.misses = m_misses;
+        stats.blocksPublished = m_published.load(std::memory_order_relaxed);
+        stats.blocksFailed = m_failed.load(std::memory_order_relaxed);
+        return stats;
+    }
+}
@@ -0,0 +1,141 @@
+#include "orbitscene.h"
+
+namespace oat
+{
+    OrbitScene::OrbitScene(unsigned int threadNum)
+        :m_virtualGroup(NULL)
+        , m_modelNum(0)
+        , m_front(0)
+        , m_inFlight(false)
+        , m_pendingChunks(0)
+        , m_pool(new ThreadPool(threadNum))
+    {
+        m_frames[0].jd = m_frames[1].jd = 0.0;
+        m_frames[0].evalTime = m_frames[1].evalTime = 0.0;
+    }
+
+    OrbitScene::~OrbitScene()
+    {
+        if (m_inFlight)
+        {
+            m_pool->wait();
+        }
+    }
+
+    size_t OrbitScene::addModel(OrbitModel* model)
+    {
+        if (model == NULL)
+        {
+            return (size_t)-1;
+        }
+        if (m_virtualGroup == NULL)
+        {
+            m_virtualGroup = new VirtualModelGroup();
+            m_groups.push_back(std::unique_ptr<ModelGroup>(m_virtualGroup));
+        }
+        m_virtualGroup->models.push_back(model);
+        m_virtualGroup->slots.push_back(m_modelNum);
+        return m_modelNum++;
+    }
+
+    void OrbitScene::resizeFrame(Frame& frame) const
+    {
+        const size_t n = m_modelNum;
+        frame.x.resize(n);
+        frame.y.resize(n);
+        frame.z.resize(n);
+        frame.vx.resize(n);
+        frame.vy.resize(n);
+        frame.vz.resize(n);
+    }
+
+    void OrbitScene::beginFrame(double jd)
+    {
+        if (m_inFlight)
+        {
+            endFrame();
+        }
+
+        Frame& frame = m_frames[1 - m_front];
+        resizeFrame(frame);
+        frame.jd = jd;
+        frame.evalTime = 0.0;
+        m_beginTime = std::chrono::steady_clock::now();
+        m_inFlight = true;
+
+        // a few chunks per worker balance models with slow out of range fallbacks
+        const size_t n = m_modelNum;
+        size_t chunkNum = (size_t)m_pool->size() * 4;
+        chunkNum = chunkNum > n ? n : chunkNum;
+        if (chunkNum == 0)
+        {
+            return;
+        }
+        const size_t chunkSize = (n + chunkNum - 1) / chunkNum;
+
+        // chunks never cross a group, so each one is a single devirtualized loop
+        m_chunks.clear();
+        for (size_t g = 0; g < m_groups.size(); ++g)
+        {
+            const size_t size = m_groups[g]->slots.size();
+            for (size_t begin = 0; begin < size; begin += chunkSize)
+            {
+                Chunk chunk;
+                chunk.group = m_groups[g].get();
+                chunk.begin = begin;
+                chunk.end = begin + chunkSize < size ? begin + chunkSize : size;
+                m_chunks.push_back(chunk);
+            }
+        }
+
+        m_pendingChunks.store((int)m_chunks.size());
+        for (size_t c = 0; c < m_chunks.size(); ++c)
+        {
+            // two words of capture stay in the small buffer of std::function, no allocation
+            m_pool->enqueue([this, c] {
+                const Chunk& chunk = m_chunks[c];
+                Frame& frame = m_frames[1 - m_front];
+                chunk.group->evaluate(chunk.begin, chunk.end, frame.jd, frame);
+                if (m_pendingChunks.fetch_sub(1) == 1)
+                {
+                    // last chunk stamps the evaluation time of the frame
+                    frame.evalTime = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - m_beginTime).count();
+                }
+            });
+        }
+    }
+
+    const OrbitScene::Frame& OrbitScene::endFrame()
+    {
+        if (m_inFlight)
+        {
+            m_pool->wait();
+            m_inFlight = false;
+            m_front = 1 - m_front;
+        }
+        return m_frames[m_front];
+    }
+
+    const OrbitScene::Frame& OrbitScene::evaluate(double jd)
+    {
+        beginFrame(jd);
+        return endFrame();
+    }
+
+    void OrbitScene::VirtualModelGroup::evaluate(size_t begin, size_t end, double jd, Frame& frame)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            Vec3 p = models[i]->positionAtJD(jd);
+            Vec3 v = models[i]->velocityAtJD(jd);
+            const size_t slot = slots[i];
+            frame.x[slot] = p.x();
+            frame.y[slot] = p.y();
+            frame.z[slot] = p.z();
+            frame.vx[slot] = v.x();
+            frame.vy[slot] = v.y();
+            frame.vz[slot] = v.z();
+        }
+    }
+}
@@ -0,0 +1,205 @@
+#include "orbitstreamer.h"
+#include <cmath>
+
+namespace oat
+{
+    OrbitStreamer::OrbitStreamer(double dDeltaTime, size_t capacity)
+        :m_deltaTime(dDeltaTime)
+        , m_capacity(2)
+        , m_bStarted(false)
+        , m_hits(0)
+        , m_misses(0)
+        , m_produced(0)
+        , m_bWake(false)
+        , m_stop(false)
+    {
+        while (m_capacity < capacity)
+        {
+            m_capacity <<= 1;
+        }
+        m_mask = m_capacity - 1;
+        m_producer = std::thread(&OrbitStreamer::producerLoop, this);
+    }
+
+    OrbitStreamer::~OrbitStreamer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop.store(true);
+        }
+        m_wake.notify_one();
+        m_producer.join();
+    }
+
+    int OrbitStreamer::attach(OrbitModel* model)
+    {
+        // the producer walks the rings once the clock runs
+        if (m_bStarted)
+        {
+            return -1;
+        }
+        std::unique_ptr<Ring> ring(new Ring);
+        ring->model = model;
+        ring->data.reset(new OrbitData[m_capacity]);
+        ring->head.store(-1);
+        ring->tail.store(-1);
+        ring->failed.store(false);
+        m_rings.push_back(std::move(ring));
+        return (int)m_rings.size() - 1;
+    }
+
+    void OrbitStreamer::update(double curJD)
+    {
+        m_bStarted = true;
+        long long k = (long long)floor(curJD / m_deltaTime);
+        for (size_t i = 0; i < m_rings.size(); ++i)
+        {
+            if (k > m_rings[i]->tail.load(std::memory_order_relaxed))
+            {
+                m_rings[i]->tail.store(k, std::memory_order_release);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bWake = true;
+        }
+        m_wake.notify_one();
+    }
+
+    long long OrbitStreamer::advance(Ring& ring, double jd)
+    {
+        long long k = (long long)floor(jd / m_deltaTime);
+        long long tail = ring.tail.load(std::memory_order_relaxed);
+        if (k < tail || tail < 0)
+        {
+            // behind the clock, the slot may already hold a newer sample
+            return -1;
+        }
+        if (k > tail)
+        {
+            // everything before k is given back to the producer
+            ring.tail.store(k, std::memory_order_release);
+        }
+        // samples below head are complete
+        if (k + 1 >= ring.head.load(std::memory_order_acquire))
+        {
+            return -1;
+        }
+        return k;
+    }
+
+    bool OrbitStreamer::stateAtJD(int handle, double jd, Vec3& position, Vec3& velocity)
+    {
+        Ring& ring = *m_rings[handle];
+        long long k = advance(ring, jd);
+        if (k < 0)
+        {
+            ++m_misses;
+            return false;
+        }
+        ++m_hits;
+        const OrbitData& d0 = ring.data[k & m_mask];
+        const OrbitData& d1 = ring.data[(k + 1) & m_mask];
+        double factor = (jd - d0.jd) / (d1.jd - d0.jd);
+        position = d0.position + (d1.position - d0.position) * factor;
+        velocity = d0.velocity + (d1.velocity - d0.velocity) * factor;
+        return true;
+    }
+
+    Vec3 OrbitStreamer::positionAtJD(int handle, double jd)
+    {
+        Vec3 position, velocity;
+        if (stateAtJD(handle, jd, position, velocity))
+        {
+            return position;
+        }
+        return m_rings[handle]->model->positionAtJD(jd);
+    }
+
+    Vec3 OrbitStreamer::velocityAtJD(int handle, double jd)
+    {
+        Vec3 position, velocity;
+        if (stateAtJD(handle, jd, position, velocity))
+        {
+            return velocity;
+        }
+        return m_rings[handle]->model->velocityAtJD(jd);
+    }
+
+    OrbitStreamer::Stats OrbitStreamer::getStats() const
+    {
+        Stats stats;
+        stats.hits = m_hits;
+        stats.misses = m_misses;
+        stats.produced = m_produced.load();
+        return stats;
+    }
+
+    size_t OrbitStreamer::fill(Ring& ring)
+    {
+        const size_t BATCH = 64;
+        long long tail = ring.tail.load(std::memory_order_acquire);
+        if (tail < 0 || ring.failed.load(std::memory_order_relaxed))
+        {
+            return 0;
+        }
+        long long head = ring.head.load(std::memory_order_relaxed);
+        if (head < tail)
+        {
+            // the clock jumped past the ring, restart at the clock
+            head = tail;
+        }
+        long long room = tail + (long long)m_capacity - head;
+        size_t n = room < (long long)BATCH ? (size_t)room : BATCH;
+        if (n == 0)
+        {
+            return 0;
+        }
+
+        double jd[BATCH];
+        OrbitData states[BATCH];
+        for (size_t i = 0; i < n; ++i)
+        {
+            jd[i] = (head + (long long)i) * m_deltaTime;
+        }
+        if (!ring.model->propagate(jd, n, states))
+        {
+            ring.failed.store(true);
+            return 0;
+        }
+        for (size_t i = 0; i < n; ++i)
+        {
+            ring.data[(head + (long long)i) & m_mask] = states[i];
+        }
+        // publish after the samples are written
+        ring.head.store(head + (long long)n, std::memory_order_release);
+        m_produced.fetch_add(n, std::memory_order_relaxed);
+        return n;
+    }
+
+    void OrbitStreamer::producerLoop()
+    {
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this] { return m_bWake || m_stop.load(); });
+                if (m_stop.load())
+                {
+                    return;
+                }
+                m_bWake = false;
+            }
+            // round robin in batches so every ring gets ahead of the clock early
+            bool bMore = true;
+            while (bMore && !m_stop.load(std::memory_order_relaxed))
+            {
+                bMore = false;
+                for (size_t i = 0; i < m_rings.size() && !m_stop.load(std::memory_order_relaxed); ++i)
+                {
+                    bMore = fill(*m_rings[i]) > 0 || bMore;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,367 @@
+#include "orbitattitude.h"
+#include "orbitmodel_sgp4.h"
+#include "orbitmodel_arena.h"
+#include "orbitscene.h"
+#include "oat_physics_const.h"
+#include "oat_math_const.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// benchmark helpers -------------------------------------------------------------------------------
+
+static const char *g_tleLine1st = "1 25544U 98067A   20290.52835648  .00000867  00000-0  22898-4 0  9993";
+// TLE epoch of g_tleLine1st, JD
+static const double g_epochJD = 2459139.02835648;
+
+static void makeTleLine2nd(char *line, double incl, double raan, int ecc, double argp, double meanAnomaly, double meanMotion)
+{
+    snprintf(line, 130, "2 25544 %8.4f %8.4f %07d %8.4f %8.4f %11.8f%5d%1d",
+             incl, raan, ecc, argp, meanAnomaly, meanMotion, 25078, 9);
+}
+
+// ISS-like second line with the plane and phase spread over the catalog
+static void makeTleLine2nd(int i, int count, char *line)
+{
+    makeTleLine2nd(line, 51.6443, 360.0 * i / count, 1405, 89.0, fmod(137.5 * i, 360.0), 15.49300004);
+}
+
+static double elapsedMs(std::chrono::steady_clock::time_point begin)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+// OrbitModel::sample into std::map vs OrbitModel::sampleInto ---------------------------------------
+
+static void benchSample(int objectNum, int ptNum)
+{
+    const double dBegin = g_epochJD - 1.0 / 24.0;
+    const double dEnd = g_epochJD + 1.0 / 24.0;
+    std::vector<std::unique_ptr<oat::OrbitModel_SGP4> > models;
+    models.reserve(objectNum);
+    char line2[130];
+    for (int i = 0; i < objectNum; ++i)
+    {
+        makeTleLine2nd(i, objectNum, line2);
+        models.push_back(std::unique_ptr<oat::OrbitModel_SGP4>(new oat::OrbitModel_SGP4(g_tleLine1st, line2, dBegin, dEnd, 1.0 / 1440.0)));
+    }
+
+    // map sample, then the copy a renderer does into its vertex buffer
+    std::vector<float> vertices((size_t)objectNum * ptNum * 3);
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < objectNum; ++i)
+    {
+        std::map<double, oat::Vec3> mapTime2Position;
+        models[i]->sample(g_epochJD, ptNum, mapTime2Position);
+        float *v = &vertices[(size_t)i * ptNum * 3];
+        for (std::map<double, oat::Vec3>::const_iterator it = mapTime2Position.begin(); it != mapTime2Position.end(); ++it)
+        {
+            *v++ = (float)it->second.x();
+            *v++ = (float)it->second.y();
+            *v++ = (float)it->second.z();
+        }
+    }
+    double dMapMs = elapsedMs(t0);
+
+    // straight into the vertex buffer, camera relative floats
+    oat::Vec3 camera(7000.0 * oat::phy_kmToSimUnit, 0.0, 0.0);
+    t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < objectNum; ++i)
+    {
+        models[i]->sampleInto(g_epochJD, ptNum, &vertices[(size_t)i * ptNum * 3], camera);
+    }
+    double dBufferMs = elapsedMs(t0);
+
+    printf("sample %d objects x %d points: map %.1f ms, sampleInto %.1f ms (%.1fx)\n",
+           objectNum, ptNum, dMapMs, dBufferMs, dMapMs / dBufferMs);
+}
+
+// OrbitModel::sampleAdaptive vs the uniform point number reaching the same error --------------------
+
+// largest chord error of a uniform sample with segNum segments over one period
+static double uniformError(oat::OrbitModel &model, double curJD, int segNum)
+{
+    double dBegin = curJD - model.getPeriod() / 2.0;
+    double dStep = model.getPeriod() / segNum;
+    double dMax = 0.0;
+    oat::Vec3 p0 = model.positionAtJD(dBegin);
+    for (int i = 1; i <= segNum; ++i)
+    {
+        oat::Vec3 p1 = model.positionAtJD(dBegin + i * dStep);
+        oat::Vec3 pm = model.positionAtJD(dBegin + (i - 0.5) * dStep);
+        oat::Vec3 chord = p1 - p0;
+        double dError = ((pm - p0) ^ chord).length() / chord.length();
+        dMax = dError > dMax ? dError : dMax;
+        p0 = p1;
+    }
+    return dMax * oat::phy_kmToSimUnit;
+}
+
+static void benchAdaptive(int objectNum)
+{
+    struct OrbitType {
+        const char *name;
+        double incl;
+        int ecc;
+        double argp;
+        double meanMotion;
+    };
+    const OrbitType types[] = {
+        {"LEO", 51.6443, 1405, 89.0, 15.49300004},
+        {"Molniya", 63.4, 7200000, 270.0, 2.00600000},
+        {"GTO", 27.0, 7300000, 180.0, 2.25000000},
+        {"GEO", 0.05, 2000, 0.0, 1.00270000},
+    };
+    // 1 pixel at 50000 km on a 1080 pixel high 60 degree view
+    oat::SampleTolerance tolerance(1.0, 5.0e7, (60.0 * PI / 180.0) / 1080.0);
+    double dMaxError = tolerance.pixelError * tolerance.cameraDistance * tolerance.pixelAngle;
+
+    std::vector<double> xyz(3 * 100000);
+    size_t adaptiveTotal = 0;
+    size_t uniformTotal = 0;
+    char line2[130];
+    for (size_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t)
+    {
+        size_t adaptiveNum = 0;
+        size_t uniformNum = 0;
+        int num = objectNum / 4 > 0 ? objectNum / 4 : 1;
+        for (int i = 0; i < num; ++i)
+        {
+            const OrbitType &type = types[t];
+            makeTleLine2nd(line2, type.incl, 360.0 * i / num, type.ecc, type.argp, fmod(137.5 * i, 360.0), type.meanMotion);
+            double dPeriod = 1.0 / type.meanMotion;
+            oat::OrbitModel_SGP4 model(g_tleLine1st, line2, g_epochJD - dPeriod, g_epochJD + dPeriod, 1.0 / 1440.0);
+
+            adaptiveNum += model.sampleAdaptive(g_epochJD - dPeriod / 2.0, g_epochJD + dPeriod / 2.0, tolerance,
+                                                &xyz[0], NULL, xyz.size() / 3);
+
+            // smallest uniform segment number reaching the same error
+            int lo = 8, hi = 16;
+            while (uniformError(model, g_epochJD, hi) > dMaxError)
+            {
+                lo = hi;
+                hi *= 2;
+            }
+            while (hi - lo > 1)
+            {
+                int mid = (lo + hi) / 2;
+                (uniformError(model, g_epochJD, mid) > dMaxError ? lo : hi) = mid;
+            }
+            uniformNum += hi + 1;
+        }
+        printf("adaptive %-8s %5d objects: %8zu vertices, uniform %8zu (%.1f%% saved)\n",
+               types[t].name, num, adaptiveNum, uniformNum, 100.0 * (1.0 - (double)adaptiveNum / uniformNum));
+        adaptiveTotal += adaptiveNum;
+        uniformTotal += uniformNum;
+    }
+    printf("adaptive mixed catalog: %zu vertices, uniform %zu (%.1f%% saved)\n",
+           adaptiveTotal, uniformTotal, 100.0 * (1.0 - (double)adaptiveTotal / uniformTotal));
+}
+
+// OrbitScene frame evaluation vs a serial loop on the render thread ---------------------------------
+
+static void benchScene(int objectNum)
+{
+    const double dBegin = g_epochJD - 1.0 / 24.0;
+    const double dEnd = g_epochJD + 1.0 / 24.0;
+    std::vector<std::unique_ptr<oat::OrbitModel_SGP4> > models;
+    oat::OrbitScene scene;
+    char line2[130];
+    for (int i = 0; i < objectNum; ++i)
+    {
+        makeTleLine2nd(i, objectNum, line2);
+        models.push_back(std::unique_ptr<oat::OrbitModel_SGP4>(new oat::OrbitModel_SGP4(g_tleLine1st, line2, dBegin, dEnd, 1.0 / 1440.0)));
+        scene.addModel(models.back().get());
+    }
+
+    const int frameNum = 100;
+    std::vector<double> xyz((size_t)objectNum * 6);
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int f = 0; f < frameNum; ++f)
+    {
+        double jd = g_epochJD + f / 86400.0;
+        for (int i = 0; i < objectNum; ++i)
+        {
+            oat::Vec3 p = models[i]->positionAtJD(jd);
+            oat::Vec3 v = models[i]->velocityAtJD(jd);
+            xyz[i * 6] = p.x(); xyz[i * 6 + 1] = p.y(); xyz[i * 6 + 2] = p.z();
+            xyz[i * 6 + 3] = v.x(); xyz[i * 6 + 4] = v.y(); xyz[i * 6 + 5] = v.z();
+        }
+    }
+    double dSerialMs = elapsedMs(t0) / frameNum;
+
+    double dEvalMs = 0.0;
+    scene.beginFrame(g_epochJD);
+    t0 = std::chrono::steady_clock::now();
+    for (int f = 1; f <= frameNum; ++f)
+    {
+        const oat::OrbitScene::Frame &frame = scene.endFrame();
+        scene.beginFrame(g_epochJD + f / 86400.0);
+        dEvalMs += frame.evalTime;
+    }
+    scene.endFrame();
+    double dFrameMs = elapsedMs(t0) / frameNum;
+
+    printf("scene %d objects: serial %.2f ms/frame, OrbitScene eval %.2f ms/frame, loop %.2f ms/frame\n",
+           objectNum, dSerialMs, dEvalMs / frameNum, dFrameMs);
+}
+
+// per-object virtual calls vs type-partitioned devirtualized groups ---------------------------------
+
+static void benchDispatch(int objectNum)
+{
+    // short caches, the dispatch is what is measured
+    const double dBegin = g_epochJD - 5.0 / 1440.0;
+    const double dEnd = g_epochJD + 5.0 / 1440.0;
+    std::vector<std::unique_ptr<oat::OrbitModel_SGP4> > models;
+    models.reserve(objectNum);
+    oat::OrbitScene virtualScene(1);
+    oat::OrbitScene typedScene(1);
+    char line2[130];
+    for (int i = 0; i < objectNum; ++i)
+    {
+        makeTleLine2nd(i, objectNum, line2);
+        models.push_back(std::unique_ptr<oat::OrbitModel_SGP4>(new oat::OrbitModel_SGP4(g_tleLine1st, line2, dBegin, dEnd, 1.0 / 1440.0)));
+        virtualScene.addModel(static_cast<oat::OrbitModel *>(models.back().get()));
+        typedScene.addModel(models.back().get());
+    }
+
+    const int frameNum = 50;
+    double dVirtualMs = 0.0;
+    double dTypedMs = 0.0;
+    for (int f = 0; f < frameNum; ++f)
+    {
+        double jd = g_epochJD + f / 86400.0;
+        dVirtualMs += virtualScene.evaluate(jd).evalTime;
+        dTypedMs += typedScene.evaluate(jd).evalTime;
+    }
+    printf("dispatch %d objects, 1 thread: virtual %.2f ms/frame, typed groups %.2f ms/frame (%.2fx)\n",
+           objectNum, dVirtualMs / frameNum, dTypedMs / frameNum, dVirtualMs / dTypedMs);
+}
+
+static void benchAttitude(int objectNum)
+{
+    const double dBegin = g_epochJD - 5.0 / 1440.0;
+    const double dEnd = g_epochJD + 5.0 / 1440.0;
+    std::vector<std::unique_ptr<oat::OrbitModel_SGP4> > models;
+    models.reserve(objectNum);
+    oat::OrbitScene scene(1);
+    oat::NadirAttitude nadir;
+    char line2[130];
+    for (int i = 0; i < objectNum; ++i)
+    {
+        makeTleLine2nd(i, objectNum, line2);
+        models.push_back(std::unique_ptr<oat::OrbitModel_SGP4>(new oat::OrbitModel_SGP4(g_tleLine1st, line2, dBegin, dEnd, 1.0 / 1440.0)));
+        models.back()->setAttitudeLaw(&nadir);
+        scene.addModel(models.back().get());
+    }
+
+    const int frameNum = 50;
+    std::vector<oat::Quat> quats(objectNum);
+    double dScalarMs = 0.0;
+    double dBatchMs = 0.0;
+    for (int f = 0; f < frameNum; ++f)
+    {
+        double jd = g_epochJD + f / 86400.0;
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < objectNum; ++i)
+        {
+            quats[i] = models[i]->quatAtJD(jd);
+        }
+        dScalarMs += elapsedMs(begin);
+
+        const oat::OrbitScene::Frame &frame = scene.evaluate(jd);
+        begin = std::chrono::steady_clock::now();
+        nadir.attitudes(jd, objectNum, &frame.x[0], &frame.y[0], &frame.z[0], &frame.vx[0], &frame.vy[0], &frame.vz[0], &quats[0]);
+        dBatchMs += elapsedMs(begin);
+    }
+    printf("nadir attitude %d objects: quatAtJD %.2f ms/frame, batch from frame %.2f ms/frame (%.1fx)\n",
+           objectNum, dScalarMs / frameNum, dBatchMs / frameNum, dScalarMs / dBatchMs);
+}
+
+// OrbitModelArena vs one heap model and cache per object -----------------------------------------
+
+// resident set size of the process, 0 where it is not available | unit: MB
+static double residentMB()
+{
+    double dResident = 0.0;
+    FILE *file = fopen("/proc/self/status", "r");
+    if (file == NULL)
+    {
+        return dResident;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        if (strncmp(line, "VmRSS:", 6) == 0)
+        {
+            dResident = atof(line + 6) / 1024.0;
+            break;
+        }
+    }
+    fclose(file);
+    return dResident;
+}
+
+static void benchArena(int objectNum)
+{
+    // one hour cache at one minute steps, the small per object caches of a large catalog
+    const double dBegin = g_epochJD - 0.5 / 24.0;
+    const double dEnd = g_epochJD + 0.5 / 24.0;
+    char line2[130];
+
+    // arena first: its slabs go back to the system on release, heap blocks freed later would be reused
+    double dResident = residentMB();
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    {
+        oat::OrbitModelArena arena;
+        for (int i = 0; i < objectNum; ++i)
+        {
+            makeTleLine2nd(i, objectNum, line2);
+            arena.create<oat::OrbitModel_SGP4>(g_tleLine1st, line2, dBegin, dEnd, 1.0 / 1440.0);
+        }
+        double dBuildMs = elapsedMs(begin);
+        double dArenaMB = residentMB() - dResident;
+        begin = std::chrono::steady_clock::now();
+        arena.clear();
+        printf("arena %d objects: build %.1f ms, teardown %.2f ms, rss +%.1f MB\n",
+               objectNum, dBuildMs, elapsedMs(begin), dArenaMB);
+    }
+
+    dResident = residentMB();
+    begin = std::chrono::steady_clock::now();
+    {
+        std::vector<oat::OrbitModel_SGP4 *> models;
+        models.reserve(objectNum);
+        for (int i = 0; i < objectNum; ++i)
+        {
+            makeTleLine2nd(i, objectNum, line2);
+            models.push_back(new oat::OrbitModel_SGP4(g_tleLine1st, line2, dBegin, dEnd, 1.0 / 1440.0));
+        }
+        double dBuildMs = elapsedMs(begin);
+        double dHeapMB = residentMB() - dResident;
+        begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < objectNum; ++i)
+        {
+            delete models[i];
+        }
+        printf("heap  %d objects: build %.1f ms, teardown %.2f ms, rss +%.1f MB\n",
+               objectNum, dBuildMs, elapsedMs(begin), dHeapMB);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int objectNum = argc > 1 ? atoi(argv[1]) : 10000;
+
+    benchArena(objectNum * 5);
+    benchSample(objectNum, 360);
+    benchAdaptive(objectNum / 100);
+    benchScene(objectNum);
+    benchDispatch(objectNum * 10);
+    benchAttitude(objectNum * 10);
+    return 0;
+}
@@ -0,0 +1,385 @@
+#include "coord/coord_footprint.h"
+#include "coord/coord_frame_graph.h"
+#include "coord/coord_lookangle.h"
+#include "coord/coord_polar.h"
+#include "coord/coord_transform.h"
+#include "oat_time_scale.h"
+#include "sgp4/SGP4.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool bOk, const char* what)
+{
+    if (!bOk)
+    {
+        std::cout << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+// Vallado, Fundamentals of Astrodynamics and Applications, example 3-15 (TEME <-> ITRF)
+static void testTemeEcef()
+{
+    const double arcsec = 3.14159265358979323846 / (180.0 * 3600.0);
+    double jd, jdFrac;
+    SGP4Funcs::jday_SGP4(2004, 4, 6, 7, 51, 28.386009, jd, jdFrac);
+    double jdut1 = jd + jdFrac + (-0.4399619) / 86400.0;
+    oatCoord::EarthOrientation orientation(jdut1, -0.140682 * arcsec, 0.333309 * arcsec);
+
+    double x = 5094.18016210, y = 6127.64465950, z = 6380.34453270;
+    double vx = -4.746131487, vy = 0.785818041, vz = 5.531931288;
+    double ex, ey, ez, evx, evy, evz;
+    oatCoord::temeToEcef(orientation, 1, &x, &y, &z, &vx, &vy, &vz, &ex, &ey, &ez, &evx, &evy, &evz);
+
+    std::cout << std::fixed;
+    std::cout.precision(7);
+    std::cout << "ITRF r: " << ex << " " << ey << " " << ez << std::endl;
+    std::cout << "ITRF v: " << evx << " " << evy << " " << evz << std::endl;
+    // km, km/s
+    check(fabs(ex - -1033.4793830) < 1e-3 && fabs(ey - 7901.2952754) < 1e-3 && fabs(ez - 6380.3565958) < 1e-3, "teme to ecef position");
+    check(fabs(evx - -3.225636520) < 1e-6 && fabs(evy - -2.872451450) < 1e-6 && fabs(evz - 5.531924446) < 1e-6, "teme to ecef velocity");
+
+    double tx, ty, tz, tvx, tvy, tvz;
+    oatCoord::ecefToTeme(orientation, 1, &ex, &ey, &ez, &evx, &evy, &evz, &tx, &ty, &tz, &tvx, &tvy, &tvz);
+    check(fabs(tx - x) < 1e-9 && fabs(ty - y) < 1e-9 && fabs(tz - z) < 1e-9, "ecef to teme position round trip");
+    check(fabs(tvx - vx) < 1e-12 && fabs(tvy - vy) < 1e-12 && fabs(tvz - vz) < 1e-12, "ecef to teme velocity round trip");
+
+    oatCoord::ECEFCoord position, velocity;
+    oatCoord::temeToEcef(orientation, 1, &x, &y, &z, &vx, &vy, &vz, &position, &velocity);
+    check(fabs(position.x - ex * 1000.0) < 1e-6 && fabs(velocity.y - evy * 1000.0) < 1e-9, "teme to ECEFCoord");
+}
+
+// geodetic -> ECEF -> geodetic over a latitude/longitude grid, surface to beyond the Moon
+static void testGeodetic()
+{
+    const double altitudes[] = {-10e3, 0.0, 1.0, 400e3, 2000e3, 20200e3, 35786e3, 384400e3};
+    std::vector<double> lon, lat, alt;
+    for (size_t a = 0; a < sizeof(altitudes) / sizeof(altitudes[0]); ++a)
+    {
+        for (int i = -180; i <= 180; ++i)
+        {
+            // poles, the equator and latitudes near both
+            double latitude = i * 0.5;
+            latitude = i == -179 ? -89.9999999 : (i == 179 ? 89.9999999 : latitude);
+            lat.push_back(latitude);
+            lon.push_back(i * 0.999);
+            alt.push_back(altitudes[a]);
+        }
+    }
+
+    size_t n = lat.size();
+    std::vector<double> x(n), y(n), z(n), lon2(n), lat2(n), alt2(n);
+    oatCoord::geodeticToEcef(n, &lon[0], &lat[0], &alt[0], &x[0], &y[0], &z[0]);
+    oatCoord::ecefToGeodetic(n, &x[0], &y[0], &z[0], &lon2[0], &lat2[0], &alt2[0]);
+
+    const double degToMeter = oatCoord::WGS84_A * 3.14159265358979323846 / 180.0;
+    double maxError = 0.0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        double cosLat = cos(lat[i] * 3.14159265358979323846 / 180.0);
+        double scale = (oatCoord::WGS84_A + alt[i]) / oatCoord::WGS84_A;
+        double error = fabs(alt2[i] - alt[i]);
+        error = std::max(error, fabs(lat2[i] - lat[i]) * degToMeter * scale);
+        error = std::max(error, fabs(lon2[i] - lon[i]) * degToMeter * scale * cosLat);
+        maxError = std::max(maxError, error);
+    }
+    std::cout << "geodetic round trip max error: " << maxError << " m" << std::endl;
+    check(maxError < 1e-3, "geodetic round trip sub-millimeter");
+
+    oatCoord::ECEFCoord ecef[2] = {oatCoord::ECEFCoord(oatCoord::WGS84_A, 0.0, 0.0),
+                                   oatCoord::ECEFCoord(0.0, 0.0, -7000e3)};
+    oatCoord::GeoCoord geo[2];
+    oatCoord::ecefToGeodetic(2, ecef, geo);
+    check(fabs(geo[0].Lontitude) < 1e-12 && fabs(geo[0].Latitude) < 1e-12 && fabs(geo[0].Altitude) < 1e-6, "ecef to geodetic on the equator");
+    // polar radius b = a (1 - f)
+    double b = oatCoord::WGS84_A * (1.0 - oatCoord::WGS84_F);
+    check(fabs(geo[1].Latitude + 90.0) < 1e-12 && fabs(geo[1].Altitude - (7000e3 - b)) < 1e-6, "ecef to geodetic at the south pole");
+
+    oatCoord::ECEFCoord back[2];
+    oatCoord::geodeticToEcef(2, geo, back);
+    check(fabs(back[0].x - ecef[0].x) < 1e-6 && fabs(back[1].z - ecef[1].z) < 1e-6, "GeoCoord to ECEFCoord");
+}
+
+static void testLookAngle()
+{
+    const double a = oatCoord::WGS84_A;
+    oatCoord::LookAngleEngine engine(2, 3);
+    engine.addStation(oatCoord::GeoCoord(0.0, 0.0, 0.0), 10.0);
+    engine.addStation(oatCoord::GeoCoord(90.0, 0.0, 0.0), 10.0);
+
+    // zenith of station 0 receding, 30 deg north of it, 45 deg east of it, below its horizon
+    double x[4] = {a + 1000e3, a + 1000e3, a + 1000e3, -a};
+    double y[4] = {0.0, 0.0, 1000e3, 0.0};
+    double z[4] = {0.0, 1000e3 / sqrt(3.0), 0.0, 0.0};
+    double vx[4] = {7000.0, 0.0, 0.0, 0.0};
+    double vy[4] = {0.0, 0.0, 0.0, 0.0};
+    double vz[4] = {0.0, 0.0, 0.0, 0.0};
+
+    std::vector<oatCoord::LookAngle> angles;
+    size_t calls = 0;
+    engine.evaluate(4, x, y, z, vx, vy, vz, [&](const oatCoord::LookAngle* batch, size_t n) {
+        angles.insert(angles.end(), batch, batch + n);
+        ++calls;
+    });
+
+    std::vector<oatCoord::LookAngle> station0;
+    for (size_t i = 0; i < angles.size(); ++i)
+    {
+        if (angles[i].station == 0) station0.push_back(angles[i]);
+        check(angles[i].elevation >= 10.0, "look angle above the mask");
+    }
+    check(station0.size() == 3 && calls >= 1, "look angle mask");
+    if (station0.size() == 3)
+    {
+        check(station0[0].satellite == 0 && fabs(station0[0].elevation - 90.0) < 1e-9 && fabs(station0[0].range - 1000e3) < 1e-6, "look angle zenith");
+        check(fabs(station0[0].rangeRate - 7000.0) < 1e-9, "look angle range rate");
+        check(fabs(station0[1].azimuth) < 1e-9 && fabs(station0[1].elevation - 60.0) < 1e-9, "look angle north");
+        check(fabs(station0[2].azimuth - 90.0) < 1e-9 && fabs(station0[2].elevation - 45.0) < 1e-9, "look angle east");
+    }
+
+    size_t all = 0;
+    engine.evaluate(4, x, y, z, NULL, NULL, NULL, [&](const oatCoord::LookAngle*, size_t n) {all += n;}, false);
+    check(all == 8, "look angle without mask");
+
+    oatCoord::ENUCoord enu = engine.toENU(0, oatCoord::ECEFCoord(a, 10.0, 20.0));
+    check(fabs(enu.x - 20.0) < 1e-9 && fabs(enu.y) < 1e-9 && fabs(enu.z - 10.0) < 1e-9, "ecef to ENUCoord");
+}
+
+static void testFootprint()
+{
+    const double deg = 3.14159265358979323846 / 180.0;
+    oatCoord::FootprintGenerator generator(36, 10.0);
+    oatCoord::GeoCoord subPoints[2] = {oatCoord::GeoCoord(175.0, 20.0, 800e3), oatCoord::GeoCoord(0.0, 30.0, 35786e3)};
+    oatCoord::Footprints footprints;
+    generator.generate(2, subPoints, footprints);
+    check(footprints.getNum() == 2 && footprints.lon.size() == 72 && footprints.vertexNum == 36, "footprint size");
+
+    // edge of the footprint sees the satellite at the minimum elevation
+    double r = oatCoord::WGS84_A;
+    double lambda = acos(r * cos(10.0 * deg) / (r + 800e3)) - 10.0 * deg;
+    check(fabs(footprints.radius[0] - lambda / deg) < 1e-12 && !footprints.pole[0] && footprints.pole[1], "footprint radius");
+    double maxError = 0.0;
+    for (size_t k = 0; k < footprints.vertexNum; ++k)
+    {
+        // haversine central angle from the sub-satellite point
+        double dlat = (footprints.lat[k] - 20.0) * deg;
+        double dlon = (footprints.lon[k] - 175.0) * deg;
+        double h = sin(dlat / 2) * sin(dlat / 2) + cos(20.0 * deg) * cos(footprints.lat[k] * deg) * sin(dlon / 2) * sin(dlon / 2);
+        maxError = std::max(maxError, fabs(2.0 * asin(sqrt(h)) - lambda));
+        maxError = std::max(maxError, fabs(footprints.lon[k] - 175.0) > 90.0 ? 1.0 : 0.0);
+    }
+    check(maxError < 1e-12, "footprint vertices on the edge circle, no wrap");
+    check(fabs(footprints.lat[0] - (20.0 + lambda / deg)) < 1e-9 && fabs(footprints.lon[0] - 175.0) < 1e-9, "footprint starts north");
+
+    // buffers are reused
+    const double* pLon = &footprints.lon[0];
+    generator.generate(1, subPoints, footprints);
+    check(&footprints.lon[0] == pLon && footprints.getNum() == 1, "footprint buffer reuse");
+}
+
+static void testFrameGraph()
+{
+    const double arcsec = 3.14159265358979323846 / (180.0 * 3600.0);
+    double jd, jdFrac;
+    SGP4Funcs::jday_SGP4(2004, 4, 6, 7, 51, 28.386009, jd, jdFrac);
+    jd += jdFrac;
+    oatCoord::FrameGraph graph;
+    graph.setPolarMotion(-0.140682 * arcsec, 0.333309 * arcsec);
+
+    // Vallado example 3-15, TEME -> J2000 with the full IAU-80 nutation; four terms are good to tens of meters
+    oat::Vec3 teme(5094180.16210, 6127644.65950, 6380344.53270);
+    oat::Vec3 gcrf = graph.transform(oatCoord::FRAME_TEME, oatCoord::FRAME_GCRF, jd, teme);
+    check((gcrf - oat::Vec3(5102508.9579, 6123011.4007, 6378136.9282)).length() < 50.0, "teme to gcrf");
+    check((graph.transform(oatCoord::FRAME_GCRF, oatCoord::FRAME_TEME, jd, gcrf) - teme).length() < 1e-6, "gcrf to teme round trip");
+
+    // the graph agrees with the batch transform
+    oatCoord::EarthOrientation orientation(jd, -0.140682 * arcsec, 0.333309 * arcsec);
+    double ex, ey, ez;
+    oatCoord::temeToEcef(orientation, 1, &teme[0], &teme[1], &teme[2], NULL, NULL, NULL, &ex, &ey, &ez, NULL, NULL, NULL);
+    oat::Vec3 itrf = graph.transform(oatCoord::FRAME_TEME, oatCoord::FRAME_ITRF, jd, teme);
+    check((itrf - oat::Vec3(ex, ey, ez)).length() < 1e-6, "teme to itrf");
+
+    // composites are built once per time tag
+    size_t builds = graph.getBuildNum();
+    for (int i = 0; i < 10; ++i)
+    {
+        graph.getTransform(oatCoord::FRAME_TEME, oatCoord::FRAME_ITRF, jd);
+    }
+    check(graph.getBuildNum() == builds, "frame transform cached");
+    graph.getTransform(oatCoord::FRAME_TEME, oatCoord::FRAME_ITRF, jd + 1.0 / 86400.0);
+    check(graph.getBuildNum() == builds + 1, "frame transform rebuilt for a new time tag");
+
+    oat::Quat q = graph.getRotation(oatCoord::FRAME_TEME, oatCoord::FRAME_GCRF, jd);
+    oat::Vec3 direction(0.6, -0.8, 0.0);
+    check((q * direction - graph.transformDirection(oatCoord::FRAME_TEME, oatCoord::FRAME_GCRF, jd, direction)).length() < 1e-12, "frame rotation quat");
+
+    // ENU agrees with the look angle engine
+    oatCoord::GeoCoord site(116.4, 39.9, 50.0);
+    graph.setSite(site);
+    oatCoord::LookAngleEngine engine;
+    engine.addStation(site);
+    oatCoord::ENUCoord enu = engine.toENU(0, oatCoord::ECEFCoord(ex, ey, ez));
+    oat::Vec3 local = graph.transform(oatCoord::FRAME_TEME, oatCoord::FRAME_ENU, jd, teme);
+    check((local - oat::Vec3(enu.x, enu.y, enu.z)).length() < 1e-6, "teme to enu");
+
+    // LVLH: the target is the origin and the Earth center straight down
+    oat::Vec3 velocity(-4746.131487, 785.818041, 5531.931288);
+    graph.setLvlhTarget(teme, velocity);
+    check(graph.transform(oatCoord::FRAME_TEME, oatCoord::FRAME_LVLH, jd, teme).length() < 1e-6, "lvlh origin");
+    oat::Vec3 center = graph.transform(oatCoord::FRAME_TEME, oatCoord::FRAME_LVLH, jd, oat::Vec3());
+    check(fabs(center.z() - teme.length()) < 1e-6 && fabs(center.x()) < 1e-6 && fabs(center.y()) < 1e-6, "lvlh nadir");
+
+    // the Earth is about 1 AU from the Sun, opposite the Sun's early April ecliptic longitude
+    double x = 0.0, y = 0.0, z = 0.0, hx, hy, hz;
+    graph.transform(oatCoord::FRAME_GCRF, oatCoord::FRAME_HELIOCENTRIC, jd, 1, &x, &y, &z, &hx, &hy, &hz);
+    double longitude = atan2(hy, hx) * 180.0 / 3.14159265358979323846;
+    double distance = sqrt(hx * hx + hy * hy + hz * hz) / 149597870700.0;
+    check(fabs(distance - 1.0) < 0.02 && fabs(longitude + 163.3) < 0.5 && fabs(hz) < 1e3, "gcrf to heliocentric");
+}
+
+// IERS finals record, fixed columns
+static void writeEop(std::ofstream& file, double mjd, double xp, double yp, double dut1, double lod)
+{
+    char line[128];
+    snprintf(line, sizeof(line), "040406 %8.2f I %9.6f%9.6f %9.6f%9.6f  I%10.7f%10.7f %7.4f",
+             mjd, xp, 0.0, yp, 0.0, dut1, 0.0, lod);
+    file << line << "\n";
+}
+
+// UTC / TAI / TT / UT1 with the built-in and loaded tables, EOP interpolation and batches
+static void testTimeScale()
+{
+    oat::TimeScaleService service;
+    double jd, jdFrac;
+    SGP4Funcs::jday_SGP4(2020, 1, 1, 0, 0, 0.0, jd, jdFrac);
+    oat::JulianDate utc(jd, jdFrac);
+    oat::JulianDate tt = service.convert(utc, oat::TIMESCALE_UTC, oat::TIMESCALE_TT);
+    check(fabs((tt - utc) * 86400.0 - 69.184) < 1e-6, "tt - utc in 2020");
+    check(fabs(service.convert(tt, oat::TIMESCALE_TT, oat::TIMESCALE_UTC) - utc) * 86400.0 < 1e-6, "tt to utc round trip");
+    // the last second before and the first after the 2016 leap second
+    SGP4Funcs::jday_SGP4(2016, 12, 31, 23, 59, 59.0, jd, jdFrac);
+    check(service.taiMinusUtc(oat::JulianDate(jd, jdFrac)) == 36.0, "tai - utc before a leap second");
+    check(service.taiMinusUtc(oat::JulianDate(jd, jdFrac).addSeconds(1.0)) == 37.0, "tai - utc after a leap second");
+
+    const char* leapPath = "test_coord_leap.dat";
+    const char* eopPath = "test_coord_finals.data";
+    {
+        std::ofstream file(leapPath);
+        file << "# MJD Date TAI-UTC\n";
+        file << "41317.0 1 1 1972 10\n";
+        file << "57754.0 1 1 2017 37\n";
+        file << "58849.0 1 1 2020 38\n";
+    }
+    {
+        std::ofstream file(eopPath);
+        writeEop(file, 53101.0, -0.140682, 0.333309, -0.4399619, 1.5563);
+        writeEop(file, 53102.0, -0.140682, 0.333309, -0.4399619, 1.5563);
+        writeEop(file, 57753.0, 0.0, 0.0, -0.590, 0.0);
+        writeEop(file, 57754.0, 0.0, 0.0, 0.406, 0.0);
+    }
+    check(service.loadLeapSeconds(leapPath) && service.getLeapSecondNum() == 3, "load leap seconds");
+    check(service.loadEop(eopPath) && service.getEopNum() == 4, "load eop");
+    check(!service.loadEop("missing_finals.data") && service.getEopNum() == 4, "load missing eop keeps the table");
+    remove(leapPath);
+    remove(eopPath);
+    check(fabs((service.convert(utc, oat::TIMESCALE_UTC, oat::TIMESCALE_TAI) - utc) * 86400.0 - 38.0) < 1e-6, "loaded leap seconds");
+
+    // Vallado's example epoch: the EOP of the table reproduce the reference ITRF position
+    SGP4Funcs::jday_SGP4(2004, 4, 6, 7, 51, 28.386009, jd, jdFrac);
+    oat::EopEntry eop;
+    check(service.eopAt(oat::JulianDate(jd, jdFrac), eop) && fabs(eop.dut1 + 0.4399619) < 1e-12
+          && fabs(eop.lod - 1.5563e-3) < 1e-12, "eop at a date");
+    oatCoord::EarthOrientation orientation = service.earthOrientation(oat::JulianDate(jd, jdFrac));
+    double x = 5094.18016210, y = 6127.64465950, z = 6380.34453270, ex, ey, ez;
+    oatCoord::temeToEcef(orientation, 1, &x, &y, &z, NULL, NULL, NULL, &ex, &ey, &ez, NULL, NULL, NULL);
+    check(fabs(ex - -1033.4793830) < 1e-3 && fabs(ey - 7901.2952754) < 1e-3 && fabs(ez - 6380.3565958) < 1e-3, "earth orientation from eop");
+
+    // across the 2016 leap second dUT1 jumps from -0.590 to 0.406 s, UT1 itself only drifts by -4 ms
+    SGP4Funcs::jday_SGP4(2016, 12, 31, 6, 0, 0.0, jd, jdFrac);
+    oat::JulianDate before(jd, jdFrac);
+    check(service.eopAt(before, eop) && fabs(eop.dut1 + 0.591) < 1e-9, "dut1 interpolation across a leap second");
+    oat::JulianDate ut1 = service.convert(before, oat::TIMESCALE_UTC, oat::TIMESCALE_UT1);
+    check(fabs((ut1 - before) * 86400.0 + 0.591) < 1e-6, "utc to ut1");
+    check(fabs(service.convert(ut1, oat::TIMESCALE_UT1, oat::TIMESCALE_UTC) - before) * 86400.0 < 1e-6, "ut1 to utc round trip");
+    check(!service.eopAt(utc, eop) && eop.dut1 == 0.406, "eop after the table");
+
+    // a monotonic stream converted in one batch matches the single conversions
+    std::vector<oat::JulianDate> stream;
+    for (int i = 0; i < 2000; ++i)
+    {
+        stream.push_back(oat::JulianDate(2451545.0 + i * 4.0, 0.0));
+    }
+    std::vector<oat::JulianDate> batch(stream.size());
+    service.convert(&stream[0], stream.size(), oat::TIMESCALE_UTC, oat::TIMESCALE_TT, &batch[0]);
+    double maxError = 0.0;
+    for (size_t i = 0; i < stream.size(); ++i)
+    {
+        oat::TimeScaleService fresh = service;
+        maxError = std::max(maxError, fabs(batch[i] - fresh.convert(stream[i], oat::TIMESCALE_UTC, oat::TIMESCALE_TT)));
+    }
+    check(maxError == 0.0, "batch conversion");
+}
+
+// bodies around an observer in all four azimuth quadrants against the cartesian difference
+static void testPolar()
+{
+    const double pi = 3.14159265358979323846;
+    const double observerRadius = 1.5e11, observerPhi = 0.3, observerTheta = 1.2;
+    oatCoord::PolarObserver observer(observerRadius, observerPhi, observerTheta);
+    const double ox = observerRadius * sin(observerTheta) * cos(observerPhi);
+    const double oy = observerRadius * sin(observerTheta) * sin(observerPhi);
+    const double oz = observerRadius * cos(observerTheta);
+
+    const size_t n = 1000;
+    std::vector<double> radius(n), phi(n), theta(n), oRadius(n), oPhi(n), oTheta(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        radius[i] = 1e10 + 7.3e9 * (double)(i % 97);
+        phi[i] = -pi + 2.0 * pi * (double)i / (double)n;
+        theta[i] = 0.05 + 3.0 * (double)((i * 37) % n) / (double)n;
+    }
+    observer.convert(n, &radius[0], &phi[0], &theta[0], &oRadius[0], &oPhi[0], &oTheta[0]);
+
+    double maxError = 0.0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        // rebuild the body position from the observer and the relative spherical position
+        double p = oPhi[i] + observerPhi, t = oTheta[i] + observerTheta;
+        double x = ox + oRadius[i] * sin(t) * cos(p) - radius[i] * sin(theta[i]) * cos(phi[i]);
+        double y = oy + oRadius[i] * sin(t) * sin(p) - radius[i] * sin(theta[i]) * sin(phi[i]);
+        double z = oz + oRadius[i] * cos(t) - radius[i] * cos(theta[i]);
+        maxError = std::max(maxError, sqrt(x * x + y * y + z * z) / radius[i]);
+    }
+    check(maxError < 1e-12, "polar relative positions");
+
+    // a body behind an observer at the origin keeps its quadrant
+    oatCoord::PolarObserver origin(0.0, 0.0, 0.0);
+    double r = 2.0, p = 0.75 * pi, t = 0.5 * pi;
+    origin.convert(1, &r, &p, &t, &r, &p, &t);
+    check(fabs(r - 2.0) < 1e-12 && fabs(p - 0.75 * pi) < 1e-12 && fabs(t - 0.5 * pi) < 1e-12, "polar azimuth quadrant");
+}
+
+int main()
+{
+    testTemeEcef();
+    testGeodetic();
+    testLookAngle();
+    testFootprint();
+    testFrameGraph();
+    testTimeScale();
+    testPolar();
+
+    if (failures > 0)
+    {
+        std::cout << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return 0;
+}
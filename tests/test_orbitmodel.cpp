@@ -1,9 +1,750 @@
 #include "orbitmodel_sgp4.h"
+#include "orbitmodel_arena.h"
+#include "orbitattitude.h"
+#include "orbitephemeris.h"
+#include "orbitephemeris_cache.h"
+#include "orbitgroundtrack.h"
+#include "orbitpolyline_lod.h"
+#include "orbitprefetcher.h"
+#include "orbitscene.h"
+#include "orbitstreamer.h"
+#include "oat_calendar.h"
+#include "oat_math_const.h"
 #include "oat_physics_const.h"
 #include "OpenGLEarth.hpp"
 #include <iostream>
 #include <fstream> // Include the necessary header file
 #include <iomanip> // Include the necessary header file
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+// poll the render thread side of a prefetcher until the block holding jd is published
+static bool waitForBlock(oat::OrbitPrefetcher& prefetcher, int handle, double jd, oat::Vec3& position, oat::Vec3& velocity)
+{
+    for (int i = 0; i < 5000; ++i)
+    {
+        if (prefetcher.stateAtJD(handle, jd, position, velocity))
+        {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+// the prefetched state at a grid sample has to be the state of the model there
+static bool matchesModel(const oat::OrbitModel& model, double jd, const oat::Vec3& position, const oat::Vec3& velocity)
+{
+    oat::OrbitData truth;
+    return model.propagate(&jd, 1, &truth) && (position - truth.position).length() < 1e-2 &&
+           (velocity - truth.velocity).length() < 1e-5;
+}
+
+static bool testPrefetcher(oat::OrbitModel_SGP4& model)
+{
+    // every queued task runs and wait() returns once they are done
+    {
+        oat::ThreadPool pool(3);
+        std::atomic<int> done(0);
+        for (int i = 0; i < 1000; ++i)
+        {
+            pool.enqueue([&done] { done.fetch_add(1); });
+        }
+        pool.wait();
+        if (done.load() != 1000)
+        {
+            std::cout << "thread pool ran " << done.load() << " of 1000 tasks" << std::endl;
+            return false;
+        }
+    }
+
+    // a clock running forward and in reverse at a few rates, 30 frames per second; the fast
+    // rates lead by more blocks than there are slots, so the slot indices wrap around
+    const double step = 1.0 / 1440.0;
+    const int blockSize = 32;
+    const int blockNum = 6;
+    const double blockSpan = step * blockSize;
+    const double rates[] = {60.0 / 86400.0, -60.0 / 86400.0, 1.0 / 24.0, -1.0 / 24.0, 0.25, -0.25};
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); ++r)
+    {
+        oat::OrbitPrefetcher prefetcher(step, blockSize, blockNum, 2);
+        int handle = prefetcher.attach(&model);
+        double jd = 2459123.9;
+        for (int frame = 0; frame < 30; ++frame, jd += rates[r] / 30.0)
+        {
+            prefetcher.update(jd, rates[r]);
+            double sampleJD = floor(jd / blockSpan) * blockSpan + 5 * step;
+            oat::Vec3 position, velocity;
+            if (!waitForBlock(prefetcher, handle, sampleJD, position, velocity) ||
+                !matchesModel(model, sampleJD, position, velocity))
+            {
+                std::cout << "prefetched block missing or wrong at rate " << rates[r] << " frame " << frame << std::endl;
+                return false;
+            }
+        }
+        oat::OrbitPrefetcher::Stats stats = prefetcher.getStats();
+        if (stats.hits < 30 || stats.blocksPublished == 0)
+        {
+            std::cout << "prefetcher published " << stats.blocksPublished << " blocks, " << stats.hits << " hits" << std::endl;
+            return false;
+        }
+    }
+
+    // blockNum blocks ahead the clock reuses the slot of its old block: the old block must not
+    // answer for the new time, and once the new one is published not for the old time either
+    {
+        oat::OrbitPrefetcher prefetcher(step, blockSize, blockNum, 2);
+        int handle = prefetcher.attach(&model);
+        const double oldJD = floor(2459123.9 / blockSpan) * blockSpan + 5 * step;
+        const double newJD = floor(2459123.9 / blockSpan + blockNum) * blockSpan + 5 * step;
+        oat::Vec3 position, velocity;
+        prefetcher.update(oldJD, 0.0);
+        if (!waitForBlock(prefetcher, handle, oldJD, position, velocity))
+        {
+            std::cout << "prefetcher published no block" << std::endl;
+            return false;
+        }
+        prefetcher.update(newJD, 0.0);
+        if ((prefetcher.stateAtJD(handle, newJD, position, velocity) && !matchesModel(model, newJD, position, velocity)) ||
+            !waitForBlock(prefetcher, handle, newJD, position, velocity) || !matchesModel(model, newJD, position, velocity) ||
+            prefetcher.stateAtJD(handle, oldJD, position, velocity))
+        {
+            std::cout << "prefetcher answered from a stale slot" << std::endl;
+            return false;
+        }
+    }
+
+    // four workers and a clock scrubbed back and forth over twice the slots: a worker publishing
+    // late must not leave a slot holding a block of another index, every stop gets its block
+    {
+        const int scrubSize = 8;
+        const double scrubSpan = step * scrubSize;
+        const double base = floor(2459123.9 / scrubSpan) * scrubSpan;
+        oat::OrbitPrefetcher prefetcher(step, scrubSize, blockNum, 4);
+        int handle = prefetcher.attach(&model);
+        for (int round = 0; round < 200; ++round)
+        {
+            for (int frame = 0; frame < 30; ++frame)
+            {
+                double jd = base + (((round * 30 + frame) * 7919) % (2 * blockNum)) * scrubSpan + 3 * step;
+                prefetcher.update(jd, (frame & 1) ? scrubSpan : -scrubSpan);
+            }
+            double jd = base + (round % (2 * blockNum)) * scrubSpan + 3 * step;
+            oat::Vec3 position, velocity;
+            prefetcher.update(jd, 0.0);
+            if (!waitForBlock(prefetcher, handle, jd, position, velocity) || !matchesModel(model, jd, position, velocity))
+            {
+                std::cout << "scrubbed prefetcher lost a block in round " << round << std::endl;
+                return false;
+            }
+        }
+    }
+
+    // a block past decay fails alone, prefetching goes on once the clock is back in range
+    {
+        oat::OrbitModel_SGP4 decaying(
+            "1 25544U 98067A   20290.52835648  .00000867  00000-0  22898-1 0  9993",
+            "2 25544  51.6443  92.0000 0001405  89.0000  271.0000 15.49300004250789",
+            2459123.5, 2459123.6, step);
+        oat::OrbitPrefetcher prefetcher(step, blockSize, blockNum, 2);
+        int handle = prefetcher.attach(&decaying);
+        oat::Vec3 position, velocity;
+        prefetcher.update(2459163.5, 0.0);
+        for (int i = 0; i < 5000 && prefetcher.getStats().blocksFailed == 0; ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        bool bFailed = prefetcher.getStats().blocksFailed > 0 && !prefetcher.stateAtJD(handle, 2459163.5, position, velocity);
+        prefetcher.update(2459124.0, 0.0);
+        if (!bFailed || !waitForBlock(prefetcher, handle, 2459124.0, position, velocity) ||
+            !matchesModel(decaying, 2459124.0, position, velocity))
+        {
+            std::cout << "a failed block stopped prefetching the model" << std::endl;
+            return false;
+        }
+    }
+
+    // destroyed with blocks queued and running: queued ones are dropped, running ones finish
+    for (int wait = 0; wait < 3; ++wait)
+    {
+        oat::OrbitPrefetcher prefetcher(step / 60.0, 20000, 16, 2);
+        for (int i = 0; i < 8; ++i)
+        {
+            prefetcher.attach(&model);
+        }
+        prefetcher.update(2459124.0, 1.0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(wait * 5));
+    }
+    return true;
+}
+
+// forward and backward cache extension, the far query fallback and the cache statistics
+static bool testCacheExtension()
+{
+    const double step = 0.0006944444444444445;
+    oat::OrbitModel_SGP4 model(
+        "1 25544U 98067A   20290.52835648  .00000867  00000-0  22898-4 0  9993",
+        "2 25544  51.6443  92.0000 0001405  89.0000  271.0000 15.49300004250789",
+        2459123.5, 2459124.0, step);
+    model.setCacheExtension(0.5);
+    const size_t size = model.getOrbitDataView().size;
+    const double front = model.getOrbitDataView().front().jd;
+    const double back = model.getOrbitDataView().back().jd;
+    const size_t copySize = model.getOrbitData().size();
+
+    // a query 10 steps past the end adds exactly 10 samples on the grid, the last one at the query
+    double jd = back + 10 * step;
+    oat::OrbitData truth;
+    oat::Vec3 position = model.positionAtJD(jd);
+    oat::OrbitDataView view = model.getOrbitDataView();
+    const oat::OrbitModel_SGP4::CacheStats* stats = &model.getCacheStats();
+    if (!model.propagate(&jd, 1, &truth) || (position - truth.position).length() > 1e-6 ||
+        view.size != size + 10 || view.back().jd != jd || stats->extendedSamples != 10 ||
+        stats->hits != 1 || stats->fallbacks != 0)
+    {
+        std::cout << "bad forward cache extension" << std::endl;
+        return false;
+    }
+
+    // 4.5 steps before the start adds 5 samples in front, still on the grid of the old start
+    jd = front - 4.5 * step;
+    position = model.positionAtJD(jd);
+    view = model.getOrbitDataView();
+    bool bGrid = true;
+    for (size_t i = 1; i < view.size; ++i)
+    {
+        bGrid = bGrid && fabs(view[i].jd - view[i - 1].jd - step) < 1e-9;
+    }
+    if (view.size != size + 15 || fabs(view.front().jd - (front - 5 * step)) > 1e-9 || !bGrid ||
+        stats->extendedSamples != 15 || stats->hits != 2 || stats->fallbacks != 0 ||
+        (position - model.positionAtJD(jd)).length() > 1e-9 || stats->hits != 3)
+    {
+        std::cout << "bad backward cache extension" << std::endl;
+        return false;
+    }
+
+    // the heap copy of getOrbitData is taken from the extended cache
+    std::vector<oat::OrbitData> copy = model.getOrbitData();
+    if (copySize != size || copy.size() != view.size || copy.front().jd != view.front().jd || copy.back().jd != view.back().jd)
+    {
+        std::cout << "getOrbitData copy differs from the extended cache" << std::endl;
+        return false;
+    }
+
+    // farther than the extension limit: sgp4 directly, the cache stays as it is
+    jd = front - 2.0;
+    position = model.positionAtJD(jd);
+    if (!model.propagate(&jd, 1, &truth) || (position - truth.position).length() > 1e-9 ||
+        model.getOrbitDataView().size != size + 15 || stats->fallbacks != 1 || stats->extendedSamples != 15)
+    {
+        std::cout << "bad far query fallback" << std::endl;
+        return false;
+    }
+
+    // without extension every query outside of the cache falls back
+    model.setCacheExtension(0.0);
+    model.resetCacheStats();
+    model.positionAtJD(back + 11 * step);
+    model.velocityAtJD(2459123.75);
+    if (stats->hits != 1 || stats->fallbacks != 1 || stats->extendedSamples != 0 ||
+        model.getOrbitDataView().size != size + 15)
+    {
+        std::cout << "cache extension not disabled" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// models without a cache (end before begin, no step) answer batches with sgp4 directly
+static bool testEmptyCacheBatch()
+{
+    const double spans[2][3] = {{2459124.0, 2459123.5, 0.0006944444444444445}, {2459123.5, 2459124.0, 0.0}};
+    for (int m = 0; m < 2; ++m)
+    {
+        oat::OrbitModel_SGP4 model(
+            "1 25544U 98067A   20290.52835648  .00000867  00000-0  22898-4 0  9993",
+            "2 25544  51.6443  92.0000 0001405  89.0000  271.0000 15.49300004250789",
+            spans[m][0], spans[m][1], spans[m][2]);
+        model.setCacheExtension(1.0);
+        double jd[3] = {2459123.6, 2459123.7, 2459130.0};
+        double position[9], velocity[9];
+        oat::OrbitData truth[3];
+        model.positionsAtJD(jd, 3, position);
+        model.velocitiesAtJD(jd, 3, velocity);
+        bool bOk = model.getOrbitDataView().empty() && model.propagate(jd, 3, truth) &&
+                   model.getCacheStats().fallbacks == 6 && model.getCacheStats().hits == 0;
+        for (int i = 0; i < 3 && bOk; ++i)
+        {
+            bOk = (truth[i].position - oat::Vec3(position[i * 3], position[i * 3 + 1], position[i * 3 + 2])).length() < 1e-9 &&
+                  (truth[i].velocity - oat::Vec3(velocity[i * 3], velocity[i * 3 + 1], velocity[i * 3 + 2])).length() < 1e-12;
+        }
+        if (!bOk)
+        {
+            std::cout << "bad batch query without a cache, span " << m << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// every adaptive segment meets the pixel error at its mid point and the turn limit, over a
+// near circular and a highly eccentric orbit
+static bool testSampleAdaptive()
+{
+    oat::OrbitModel_SGP4 iss(
+        "1 25544U 98067A   20290.52835648  .00000867  00000-0  22898-4 0  9993",
+        "2 25544  51.6443  92.0000 0001405  89.0000  271.0000 15.49300004250789",
+        2459123.5, 2459124.5, 0.0006944444444444445);
+    oat::OrbitModel_SGP4 molniya(
+        "1 21118U 91012A   20290.50000000  .00000100  00000-0  10000-3 0  9990",
+        "2 21118  63.2000 100.0000 7200000 270.0000  10.0000  2.00600000 99990",
+        2459123.5, 2459124.5, 0.0006944444444444445);
+    oat::OrbitModel_SGP4* models[2] = {&iss, &molniya};
+    const size_t capacity = 4096;
+    std::vector<double> xyz(capacity * 3), jd(capacity);
+    for (int m = 0; m < 2; ++m)
+    {
+        oat::OrbitModel_SGP4& model = *models[m];
+        const double beginJD = 2459123.5, endJD = beginJD + model.getPeriod();
+        size_t coarse = 0, fine = 0;
+        for (double pixelError = 4.0; pixelError >= 0.25; pixelError *= 0.5)
+        {
+            oat::SampleTolerance tolerance(pixelError, 4e7, 0.001, 0.3);
+            const double dMaxError = pixelError * 4e7 * 0.001;
+            size_t n = model.sampleAdaptive(beginJD, endJD, tolerance, &xyz[0], &jd[0], capacity);
+            bool bOk = n > 1 && n < capacity && jd[0] == beginJD && jd[n - 1] == endJD;
+            for (size_t i = 1; i < n && bOk; ++i)
+            {
+                oat::Vec3 a(xyz[i * 3 - 3], xyz[i * 3 - 2], xyz[i * 3 - 1]);
+                oat::Vec3 b(xyz[i * 3], xyz[i * 3 + 1], xyz[i * 3 + 2]);
+                oat::Vec3 mid = model.positionAtJD(0.5 * (jd[i - 1] + jd[i])) * oat::phy_kmToSimUnit;
+                oat::Vec3 chord = b - a;
+                double dError = ((mid - a) ^ chord).length() / chord.length();
+                double dTurn = acos(std::min(1.0, (a * b) / (a.length() * b.length())));
+                bOk = jd[i] > jd[i - 1] && dError <= dMaxError * 1.0001 && dTurn <= 0.3 + 1e-9;
+            }
+            if (!bOk)
+            {
+                std::cout << "adaptive sample of model " << m << " breaks the tolerance at " << pixelError << " px" << std::endl;
+                return false;
+            }
+            coarse = coarse == 0 ? n : coarse;
+            fine = n;
+        }
+        // a 16 times finer tolerance needs about 4 times the points where the error, not the turn, rules
+        if (fine < 2 * coarse)
+        {
+            std::cout << "adaptive sample of model " << m << " does not refine, " << coarse << " -> " << fine << " points" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// LOD levels keep the ends of the cache, thin out with distance and stay within the tolerance
+static bool testPolylineLOD(const oat::OrbitModel_SGP4& model)
+{
+    oat::OrbitDataView cache = model.getOrbitDataView();
+    oat::OrbitPolylineLOD lod(model, 8);
+    if (lod.getLevelNum() != 8)
+    {
+        std::cout << "polyline LOD built " << lod.getLevelNum() << " levels" << std::endl;
+        return false;
+    }
+    for (int k = 0; k < lod.getLevelNum(); ++k)
+    {
+        const std::vector<oat::Vec3>& vertices = lod.getVertices(k);
+        const std::vector<double>& times = lod.getTimes(k);
+        if (times.front() != cache.front().jd || times.back() != cache.back().jd ||
+            vertices.front() != cache.front().position * oat::phy_kmToSimUnit ||
+            vertices.back() != cache.back().position * oat::phy_kmToSimUnit ||
+            (k > 0 && (vertices.size() >= lod.getVertices(k - 1).size() || lod.getMaxError(k) < lod.getMaxError(k - 1))))
+        {
+            std::cout << "polyline LOD level " << k << " lost an end or does not thin out" << std::endl;
+            return false;
+        }
+    }
+
+    size_t previous = cache.size + 1;
+    for (double distance = 1e6; distance <= 1e9; distance *= 10.0)
+    {
+        oat::SampleTolerance tolerance(1.0, distance, 0.001);
+        const double dMaxError = distance * 0.001;
+        const int level = lod.selectLevel(tolerance);
+        const size_t stride = (size_t)1 << level;
+        const std::vector<oat::Vec3>& vertices = lod.getVertices(level);
+        bool bOk = vertices.size() <= previous;
+        // every cache sample skipped by the level lies within the tolerance of its chord
+        for (size_t i = 0; i < cache.size && bOk; ++i)
+        {
+            size_t k = i / stride;
+            if (k + 1 >= vertices.size())
+            {
+                break;
+            }
+            oat::Vec3 chord = vertices[k + 1] - vertices[k];
+            oat::Vec3 offset = cache[i].position * oat::phy_kmToSimUnit - vertices[k];
+            bOk = (offset ^ chord).length() / chord.length() <= dMaxError;
+        }
+        if (!bOk)
+        {
+            std::cout << "polyline LOD level " << level << " breaks the tolerance at distance " << distance << std::endl;
+            return false;
+        }
+        previous = vertices.size();
+    }
+    if (previous * 8 > cache.size)
+    {
+        std::cout << "polyline LOD keeps " << previous << " vertices far away" << std::endl;
+        return false;
+    }
+
+    // a sliding window reports only the vertices that scrolled in and out
+    const double center = 0.5 * (cache.front().jd + cache.back().jd);
+    oat::OrbitPolylineLOD::WindowDelta before = lod.update(center, 0.05, 0.1, 2);
+    const oat::OrbitPolylineLOD::WindowDelta& after = lod.update(center + 0.01, 0.05, 0.1, 2);
+    if (!before.bReset || after.bReset || after.retiredFront == 0 || after.appendedBack == 0 ||
+        after.last - after.first != before.last - before.first - after.retiredFront - after.retiredBack +
+                                     after.appendedFront + after.appendedBack ||
+        !lod.update(center + 0.5, 0.05, 0.1, 2).bReset || !lod.update(center + 0.5, 0.05, 0.1, 3).bReset)
+    {
+        std::cout << "bad polyline LOD window delta" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static bool testScene(oat::OrbitModel_SGP4& model)
+{
+    oat::OrbitScene scene(2);
+    if (scene.addModel((oat::OrbitModel_SGP4*)NULL) != (size_t)-1 ||
+        scene.addModel((oat::OrbitModel*)NULL) != (size_t)-1 || scene.getModelNum() != 0)
+    {
+        std::cout << "scene accepted a NULL model" << std::endl;
+        return false;
+    }
+    // the same model in the typed and the virtual group
+    if (scene.addModel(&model) != 0 || scene.addModel((oat::OrbitModel*)&model) != 1)
+    {
+        std::cout << "scene returned wrong model indices" << std::endl;
+        return false;
+    }
+    oat::OrbitDataView cache = model.getOrbitDataView();
+    for (int f = 0; f < 5; ++f)
+    {
+        double jd = cache.front().jd + (cache.back().jd - cache.front().jd) * f / 5.0;
+        const oat::OrbitScene::Frame& frame = scene.evaluate(jd);
+        oat::Vec3 p = model.positionAtJD(jd);
+        for (size_t i = 0; i < 2; ++i)
+        {
+            if (frame.jd != jd || frame.x[i] != p.x() || frame.y[i] != p.y() || frame.z[i] != p.z())
+            {
+                std::cout << "scene frame " << f << " model " << i << " does not match positionAtJD" << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// a consumer thread drives the clock of an OrbitStreamer while its producer thread fills the ring
+static bool testStreamer(oat::OrbitModel_SGP4& model)
+{
+    const double step = 0.0006944444444444445;
+    const size_t capacity = 16;
+    std::string error;
+    std::thread consumer([&] {
+        oat::OrbitStreamer streamer(step, capacity);
+        const int handle = streamer.attach(&model);
+        const long long k0 = (long long)floor(2459123.6 / step);
+
+        // the producer reaches produced samples and stops there
+        auto settle = [&](unsigned long long produced) {
+            std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (streamer.getStats().produced < produced && std::chrono::steady_clock::now() < deadline)
+            {
+                std::this_thread::yield();
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            return streamer.getStats().produced == produced;
+        };
+        // state read at jd once produced, equal to propagate interpolated between the samples around jd
+        auto check = [&](double jd) {
+            oat::Vec3 position, velocity;
+            std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (!streamer.stateAtJD(handle, jd, position, velocity))
+            {
+                if (std::chrono::steady_clock::now() > deadline)
+                {
+                    return false;
+                }
+                std::this_thread::yield();
+            }
+            long long k = (long long)floor(jd / step);
+            double sampleJD[2] = {k * step, (k + 1) * step};
+            oat::OrbitData truth[2];
+            if (!model.propagate(sampleJD, 2, truth))
+            {
+                return false;
+            }
+            double factor = (jd - truth[0].jd) / (truth[1].jd - truth[0].jd);
+            oat::Vec3 p = truth[0].position + (truth[1].position - truth[0].position) * factor;
+            oat::Vec3 v = truth[0].velocity + (truth[1].velocity - truth[0].velocity) * factor;
+            return (position - p).length() < 1e-9 && (velocity - v).length() < 1e-12;
+        };
+
+        // a held clock lets the producer run exactly one ring ahead
+        streamer.update(k0 * step);
+        if (handle != 0 || streamer.attach(&model) != -1 || !settle(capacity) || !check((k0 + 0.5) * step))
+        {
+            error = "streamer did not fill the ring once";
+            return;
+        }
+        // the last ring sample has no successor, the miss releases the samples before it and the
+        // next update refills them
+        oat::Vec3 position, velocity;
+        bool bMiss = !streamer.stateAtJD(handle, (k0 + capacity - 0.5) * step, position, velocity);
+        streamer.update(k0 * step);
+        if (!bMiss || !settle(2 * capacity - 1))
+        {
+            error = "streamer ran past the ring";
+            return;
+        }
+        // the clock goes around the ring 8 times
+        for (long long k = k0 + capacity - 1; k < k0 + 9 * (long long)capacity; ++k)
+        {
+            double jd = (k + 0.37) * step;
+            streamer.update(jd);
+            if (!check(jd))
+            {
+                error = "streamed state differs from propagate after wrap-around";
+                return;
+            }
+        }
+        // behind the clock falls back to the model, a jump past the ring restarts at the clock
+        double behind = (k0 + 2.5) * step;
+        double jump = (k0 + 1000.25) * step;
+        streamer.update(jump);
+        if (streamer.stateAtJD(handle, behind, position, velocity) ||
+            streamer.positionAtJD(handle, behind) != model.positionAtJD(behind) || !check(jump))
+        {
+            error = "streamer mishandled a query behind the clock or a clock jump";
+            return;
+        }
+        oat::OrbitStreamer::Stats stats = streamer.getStats();
+        if (stats.hits < 8 * capacity || stats.misses < 2)
+        {
+            error = "streamer statistics are off";
+        }
+    });
+    consumer.join();
+    if (!error.empty())
+    {
+        std::cout << error << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static bool testMemoryArena()
+{
+    // deallocate only rewinds the most recent allocation
+    oat::MemoryArena arena(1024);
+    char* a = static_cast<char*>(arena.allocate(100));
+    char* b = static_cast<char*>(arena.allocate(48));
+    arena.deallocate(a, 100);
+    if (arena.getUsedSize() != 148 || ((uintptr_t)a & 15) != 0 || b < a + 100)
+    {
+        std::cout << "arena rewound an allocation below the top" << std::endl;
+        return false;
+    }
+    arena.deallocate(b, 48);
+    if (arena.getUsedSize() != 100 || arena.allocate(48) != b || arena.getReservedSize() != 1024)
+    {
+        std::cout << "arena did not rewind its top allocation" << std::endl;
+        return false;
+    }
+    // an oversized request gets a slab of its own, the current slab keeps filling
+    char* big = static_cast<char*>(arena.allocate(4096));
+    char* c = static_cast<char*>(arena.allocate(16, 64));
+    if (arena.getReservedSize() != 1024 + 4096 + 16 || big == NULL || c < b + 48 || c >= b + 48 + 64 ||
+        ((uintptr_t)c & 63) != 0)
+    {
+        std::cout << "arena oversized allocation broke the current slab" << std::endl;
+        return false;
+    }
+
+    // containers draw from the arena, copies fall back to the heap and moves keep the arena
+    typedef std::vector<int, oat::ArenaAllocator<int> > IntVector;
+    IntVector v{oat::ArenaAllocator<int>(&arena)};
+    for (int i = 0; i < 100; ++i)
+    {
+        v.push_back(i);
+    }
+    IntVector copy(v);
+    IntVector moved(std::move(copy));
+    IntVector movedArena(std::move(v));
+    if (copy.get_allocator().getArena() != NULL || moved.get_allocator().getArena() != NULL || moved.size() != 100 ||
+        movedArena.get_allocator().getArena() != &arena || moved != movedArena)
+    {
+        std::cout << "arena allocator copy or move is wrong" << std::endl;
+        return false;
+    }
+
+    // containers sharing one arena grow from several threads
+    {
+        oat::MemoryArena shared(4096);
+        std::vector<IntVector> vectors;
+        for (int t = 0; t < 4; ++t)
+        {
+            vectors.emplace_back(oat::ArenaAllocator<int>(&shared));
+        }
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < vectors.size(); ++t)
+        {
+            threads.push_back(std::thread([&vectors, t] {
+                for (int i = 0; i < 20000; ++i)
+                {
+                    vectors[t].push_back(i * (int)(t + 1));
+                }
+            }));
+        }
+        for (size_t t = 0; t < threads.size(); ++t)
+        {
+            threads[t].join();
+        }
+        for (size_t t = 0; t < vectors.size(); ++t)
+        {
+            bool bOk = vectors[t].size() == 20000 && vectors[t].get_allocator().getArena() == &shared;
+            for (int i = 0; i < 20000 && bOk; ++i)
+            {
+                bOk = vectors[t][i] == i * (int)(t + 1);
+            }
+            if (!bOk)
+            {
+                std::cout << "arena vector " << t << " corrupted by concurrent growth" << std::endl;
+                return false;
+            }
+        }
+    }
+
+    // a model copied out of an OrbitModelArena owns a heap cache
+    oat::OrbitModelArena models;
+    oat::OrbitModel_SGP4* model = models.create<oat::OrbitModel_SGP4>(
+        "1 25544U 98067A   20290.52835648  .00000867  00000-0  22898-4 0  9993",
+        "2 25544  51.6443  92.0000 0001405  89.0000  271.0000 15.49300004250789",
+        2459123.5, 2459123.6, 0.0006944444444444445);
+    oat::OrbitModel_SGP4 heapModel(*model);
+    if (model->getOrbitCache().get_allocator().getArena() == NULL ||
+        heapModel.getOrbitCache().get_allocator().getArena() != NULL ||
+        heapModel.getOrbitCache().size() != model->getOrbitCache().size() ||
+        heapModel.positionAtJD(2459123.55) != model->positionAtJD(2459123.55))
+    {
+        std::cout << "copied arena model does not own a heap cache" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// same rotation, q and -q included
+static bool sameRotation(const oat::Quat& a, const oat::Quat& b, double tolerance)
+{
+    return fabs(fabs(a.asVec4() * b.asVec4()) - 1.0) < tolerance;
+}
+
+// rotation of angle about a unit axis
+static oat::Quat axisAngle(double angle, const oat::Vec3& axis)
+{
+    double s = sin(0.5 * angle);
+    return oat::Quat(axis.x() * s, axis.y() * s, axis.z() * s, cos(0.5 * angle));
+}
+
+static bool testAttitude(oat::OrbitModel_SGP4& model)
+{
+    oat::NadirAttitude nadir;
+    oat::VelocityAttitude velocity;
+    oat::OrbitDataView cache = model.getOrbitDataView();
+    for (int k = 0; k < 8; ++k)
+    {
+        double jd = cache.front().jd + (cache.back().jd - cache.front().jd) * k / 8.0;
+        oat::Vec3 r = model.positionAtJD(jd);
+        oat::Vec3 v = model.velocityAtJD(jd);
+        oat::Vec3 down = -r / r.length();
+        oat::Vec3 forward = v / v.length();
+        oat::Vec3 normal = (r ^ v) / (r ^ v).length();
+
+        model.setAttitudeLaw(&nadir);
+        oat::Quat q = model.quatAtJD(jd);
+        if ((q * oat::Vec3(0, 0, 1) - down).length() > 1e-6 || (q * oat::Vec3(0, 1, 0) + normal).length() > 1e-6)
+        {
+            std::cout << "nadir attitude does not point z to -r at " << jd << std::endl;
+            return false;
+        }
+        model.setAttitudeLaw(&velocity);
+        q = model.quatAtJD(jd);
+        if ((q * oat::Vec3(1, 0, 0) - forward).length() > 1e-6 || (q * oat::Vec3(0, 1, 0) + normal).length() > 1e-6)
+        {
+            std::cout << "velocity attitude does not point x along v at " << jd << std::endl;
+            return false;
+        }
+
+        // the batch overload runs the same kernel
+        double x = r.x(), y = r.y(), z = r.z(), vx = v.x(), vy = v.y(), vz = v.z();
+        oat::Quat batch;
+        velocity.attitudes(jd, 1, &x, &y, &z, &vx, &vy, &vz, &batch);
+        if (batch != q)
+        {
+            std::cout << "batch velocity attitude differs at " << jd << std::endl;
+            return false;
+        }
+    }
+    model.setAttitudeLaw(NULL);
+
+    // endpoints and midpoint of a 120 deg turn, the negated end takes the same shorter arc
+    const oat::Vec3 axis = oat::Vec3(1, 2, 3) / oat::Vec3(1, 2, 3).length();
+    const oat::Quat from = axisAngle(0.3, axis);
+    const oat::Quat to = axisAngle(0.3 + 2.0 * PI / 3.0, axis);
+    const oat::Quat mid = axisAngle(0.3 + PI / 3.0, axis);
+    const oat::Quat ends[2] = {to, -to};
+    for (int e = 0; e < 2; ++e)
+    {
+        if (!sameRotation(oat::slerp(from, ends[e], 0.0), from, 1e-12) || !sameRotation(oat::slerp(from, ends[e], 1.0), to, 1e-12) ||
+            !sameRotation(oat::slerp(from, ends[e], 0.5), mid, 1e-12) ||
+            !sameRotation(oat::nlerp(from, ends[e], 0.0), from, 1e-12) || !sameRotation(oat::nlerp(from, ends[e], 1.0), to, 1e-12) ||
+            !sameRotation(oat::nlerp(from, ends[e], 0.5), mid, 1e-12))
+        {
+            std::cout << "slerp/nlerp misses the endpoints or the midpoint" << std::endl;
+            return false;
+        }
+        // nlerp runs ahead of slerp near the ends of the arc but stays close
+        oat::Quat quarter = axisAngle(0.3 + PI / 6.0, axis);
+        if (!sameRotation(oat::slerp(from, ends[e], 0.25), quarter, 1e-12) ||
+            !sameRotation(oat::nlerp(from, ends[e], 0.25), quarter, 1e-3))
+        {
+            std::cout << "slerp/nlerp quarter turn is off" << std::endl;
+            return false;
+        }
+        oat::Quat batch[2];
+        oat::Quat fromN[2] = {from, from};
+        oat::Quat toN[2] = {ends[e], ends[e]};
+        oat::nlerp(fromN, toN, 2, 0.25, batch);
+        if (batch[1] != oat::nlerp(from, ends[e], 0.25))
+        {
+            std::cout << "batch nlerp differs from nlerp" << std::endl;
+            return false;
+        }
+        oat::slerp(fromN, toN, 2, 0.25, batch);
+        if (batch[1] != oat::slerp(from, ends[e], 0.25))
+        {
+            std::cout << "batch slerp differs from slerp" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
 
 int main(int argc, char **argv)
 {
@@ -38,6 +779,241 @@ int main(int argc, char **argv)
         
     }
     outfile.close();
+
+    // batch query must match the scalar query, inside and outside of the cache
+    double jds[4] = {2459123.5, 2459123.71234, 2459124.5, 2459125.0};
+    double xyz[12];
+    model.positionsAtJD(jds, 4, xyz);
+    for (int i = 0; i < 4; ++i)
+    {
+        oat::Vec3 p = model.positionAtJD(jds[i]);
+        if ((p - oat::Vec3(xyz[i * 3], xyz[i * 3 + 1], xyz[i * 3 + 2])).length() > 1e-9)
+        {
+            std::cout << "positionsAtJD mismatch at jd " << jds[i] << std::endl;
+            return 1;
+        }
+    }
+
+    // metrics come from the elements: ISS period ~92.9 min, every cached sample inside the bounding sphere
+    if (fabs(model.getPeriod() * 1440.0 - 1440.0 / 15.49300004) > 0.5 ||
+        model.getPerigeeRadius() >= model.getApogeeRadius())
+    {
+        std::cout << "bad orbit metrics, period " << model.getPeriod() << std::endl;
+        return 1;
+    }
+    for (size_t i = 0; i < oribitData.size(); ++i)
+    {
+        if (oribitData[i].position.length() > model.getBoundingRadius())
+        {
+            std::cout << "sample outside of the bounding radius at jd " << oribitData[i].jd << std::endl;
+            return 1;
+        }
+    }
+
+    // the lazy generator walks the same grid as the cache, in small batches
+    size_t generated = 0;
+    for (const oat::OrbitData& data : oat::EphemerisGenerator(model, 2459123.5, 2459124.5, 0.0006944444444444445, 100))
+    {
+        if (generated >= oribitData.size() || fabs(data.jd - oribitData[generated].jd) > 1e-8 ||
+            (data.position - oribitData[generated].position).length() > 1e-3)
+        {
+            std::cout << "generator mismatch at sample " << generated << std::endl;
+            return 1;
+        }
+        ++generated;
+    }
+    if (generated != oribitData.size())
+    {
+        std::cout << "generator produced " << generated << " of " << oribitData.size() << " samples" << std::endl;
+        return 1;
+    }
+
+    // a window view points into the cache, a move hands the cache over without copying it
+    oat::OrbitDataView cache = model.getOrbitDataView();
+    oat::OrbitDataView window = model.getOrbitDataView(2459123.75, 2459124.0);
+    if (window.empty() || window.front().jd < 2459123.75 || window.back().jd > 2459124.0 ||
+        window.begin() < cache.begin() || window.end() > cache.end())
+    {
+        std::cout << "bad orbit data view" << std::endl;
+        return 1;
+    }
+    const oat::OrbitData* pCache = cache.data;
+    oat::OrbitModel_SGP4 moved(std::move(model));
+    if (moved.getOrbitDataView().data != pCache)
+    {
+        std::cout << "move copied the orbit data cache" << std::endl;
+        return 1;
+    }
+
+    // identical models share one ephemeris block while sharing is on
+    oat::EphemerisCache::instance().setEnabled(true);
+    {
+        oat::OrbitModel_SGP4 first(
+            "1 25544U 98067A   20290.52835648  .00000867  00000-0  22898-4 0  9993",
+            "2 25544  51.6443  92.0000 0001405  89.0000  271.0000 15.49300004250789",
+            2459123.5, 2459124.5, 0.0006944444444444445);
+        oat::OrbitModel_SGP4 second(
+            "1 25544U 98067A   20290.52835648  .00000867  00000-0  22898-4 0  9993\r\n",
+            "2 25544  51.6443  92.0000 0001405  89.0000  271.0000 15.49300004250789",
+            2459123.5, 2459124.5, 0.0006944444444444445);
+        oat::EphemerisCache::Stats stats = oat::EphemerisCache::instance().getStats();
+        if (!second.getShared() || &first.getOrbitCache() != &second.getOrbitCache() ||
+            stats.hits != 1 || stats.misses != 1 || stats.blocks != 1 ||
+            (second.positionAtJD(2459123.71234) - moved.positionAtJD(2459123.71234)).length() > 1e-9)
+        {
+            std::cout << "ephemeris block not shared" << std::endl;
+            return 1;
+        }
+    }
+    oat::EphemerisCache::instance().setEnabled(false);
+    if (oat::EphemerisCache::instance().getStats().blocks != 0)
+    {
+        std::cout << "ephemeris block outlived its models" << std::endl;
+        return 1;
+    }
+
+    // two part dates keep microseconds far from the epoch where a single JD rounds to ~20 us
+    oat::JulianDate epoch = moved.getEpoch();
+    oat::JulianDate later[2] = {epoch + 1000.0, epoch + 1000.0};
+    later[1].addSeconds(1e-6);
+    double tsince[2];
+    moved.tsinceAtJD(later, 2, tsince);
+    oat::OrbitData precise[2];
+    if (fabs(tsince[0] - 1440000.0) > 1e-9 || fabs((tsince[1] - tsince[0]) * 60.0 - 1e-6) > 1e-7 ||
+        !moved.propagate(later, 1, precise) || !(later[0] < later[1]) || later[1].fraction >= 1.0)
+    {
+        std::cout << "bad two part julian date" << std::endl;
+        return 1;
+    }
+
+    // one day of ground track on a 5 min step, refined to 1 deg and split at the antimeridian
+    oat::GroundTrack track;
+    oat::GroundTrackGenerator trackGenerator(1.0);
+    if (!trackGenerator.generate(moved, 2459123.5, 2459124.5, 5.0 / 1440.0, track) || track.getSegmentNum() < 2 ||
+        track.jd.front() != 2459123.5 || fabs(track.jd.back() - 2459124.5) > 1e-9)
+    {
+        std::cout << "bad ground track" << std::endl;
+        return 1;
+    }
+    for (size_t s = 0; s < track.getSegmentNum(); ++s)
+    {
+        size_t first = track.segments[s];
+        size_t last = first + track.getSegmentSize(s) - 1;
+        bool bBad = (s > 0 && fabs(track.lon[first]) != 180.0) || (s + 1 < track.getSegmentNum() && fabs(track.lon[last]) != 180.0);
+        for (size_t i = first + 1; i <= last && !bBad; ++i)
+        {
+            bBad = fabs(track.lon[i] - track.lon[i - 1]) > 2.0 || fabs(track.lat[i]) > 52.0;
+        }
+        if (bBad)
+        {
+            std::cout << "ground track polyline " << s << " wraps or is too coarse" << std::endl;
+            return 1;
+        }
+    }
+
+    if (!testPrefetcher(moved) || !testCacheExtension() || !testEmptyCacheBatch() ||
+        !testSampleAdaptive() || !testPolylineLOD(moved) || !testScene(moved) ||
+        !testAttitude(moved) || !testMemoryArena() || !testStreamer(moved))
+    {
+        return 1;
+    }
+
+    // a high drag element set decays within 40 days, a decayed sample in the middle of a batch fails it
+    oat::OrbitModel_SGP4 decaying(
+        "1 25544U 98067A   20290.52835648  .00000867  00000-0  22898-1 0  9993",
+        "2 25544  51.6443  92.0000 0001405  89.0000  271.0000 15.49300004250789",
+        2459123.5, 2459123.6, 0.0006944444444444445);
+    double decayJD[3] = {2459124.5, 2459163.5, 2459125.5};
+    oat::OrbitData decayData[3];
+    oat::JulianDate decayDates[3] = {oat::JulianDate(decayJD[0]), oat::JulianDate(decayJD[1]), oat::JulianDate(decayJD[2])};
+    if (decaying.propagate(decayJD, 3, decayData) || !decaying.propagate(decayJD, 1, decayData) ||
+        decaying.propagate(decayDates, 3, decayData) || !decaying.propagate(decayDates, 1, decayData))
+    {
+        std::cout << "decayed sample inside a batch not reported" << std::endl;
+        return 1;
+    }
+    // an out of cache query past decay answers a zero state and is counted as a failure
+    if (decaying.positionAtJD(2459163.5) != oat::Vec3(0, 0, 0) || decaying.velocityAtJD(2459163.5) != oat::Vec3(0, 0, 0) ||
+        decaying.getCacheStats().failures != 2 || decaying.positionAtJD(2459124.5) == oat::Vec3(0, 0, 0) ||
+        decaying.getCacheStats().failures != 2 || decaying.getCacheStats().fallbacks != 3)
+    {
+        std::cout << "decayed fallback not reported" << std::endl;
+        return 1;
+    }
+
+    // batch calendar <-> JD: the J2000 epoch, agreement with Cal2jd and exact round trips through
+    // JD and ISO-8601 for microsecond timestamps over years 1 to 9999
+    oat::CalendarTime j2000 = {2000, 1, 1, 12, 0, 0, 0};
+    oat::JulianDate j2000Jd;
+    oat::calendarToJd(&j2000, 1, &j2000Jd);
+    if (j2000Jd.day != 2451545.0 || j2000Jd.fraction != 0.0)
+    {
+        std::cout << "bad calendar to JD" << std::endl;
+        return 1;
+    }
+    const size_t calendarNum = 100000;
+    std::vector<oat::CalendarTime> calendar(calendarNum), calendarBack(calendarNum);
+    std::vector<oat::JulianDate> calendarJd(calendarNum);
+    std::vector<double> singleJd(calendarNum);
+    unsigned long long seed = 88172645463325252ULL;
+    for (size_t i = 0; i < calendarNum; ++i)
+    {
+        seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+        oat::CalendarTime& cal = calendar[i];
+        cal.year = 1 + (int)(seed % 9999);
+        cal.month = 1 + (int)(seed / 9999 % 12);
+        cal.day = 1 + (int)(seed / 119988 % 28);
+        cal.hour = (int)(seed / 3359664 % 24);
+        cal.minute = (int)(seed / 80631936 % 60);
+        cal.second = (int)(seed / 4837916160ULL % 60);
+        cal.microsecond = (int)(seed / 290274969600ULL % 1000000);
+    }
+    oat::calendarToJd(&calendar[0], calendarNum, &calendarJd[0]);
+    oat::calendarToJd(&calendar[0], calendarNum, &singleJd[0]);
+    oat::jdToCalendar(&calendarJd[0], calendarNum, &calendarBack[0]);
+    std::vector<char> isoText(calendarNum * (oat::ISO8601_SIZE + 1));
+    std::vector<const char*> isoRecords(calendarNum);
+    std::vector<oat::JulianDate> isoJd(calendarNum);
+    for (size_t i = 0; i < calendarNum; ++i)
+    {
+        isoRecords[i] = &isoText[i * (oat::ISO8601_SIZE + 1)];
+    }
+    if (oat::formatIso8601(&calendarJd[0], calendarNum, &isoText[0]) != calendarNum ||
+        oat::parseIso8601(&isoRecords[0], calendarNum, &isoJd[0]) != calendarNum)
+    {
+        std::cout << "bad ISO-8601 batch" << std::endl;
+        return 1;
+    }
+    for (size_t i = 0; i < calendarNum; ++i)
+    {
+        const oat::CalendarTime& a = calendar[i];
+        const oat::CalendarTime& b = calendarBack[i];
+        double reference = oat::Cal2jd(a.year, a.month, a.day, a.hour, a.minute, a.second) + a.microsecond * 1e-6 / 86400.0;
+        if (a.year != b.year || a.month != b.month || a.day != b.day || a.hour != b.hour || a.minute != b.minute ||
+            a.second != b.second || a.microsecond != b.microsecond || isoJd[i] != calendarJd[i] ||
+            fabs(calendarJd[i].jd() - reference) > 1e-8 || fabs(singleJd[i] - reference) > 1e-8)
+        {
+            std::cout << "calendar round trip failed at " << isoRecords[i] << std::endl;
+            return 1;
+        }
+    }
+    oat::CalendarTime parsed;
+    const char* badIso[] = {"2020-02-30", "2019-02-29T00:00:00", "2020-13-01", "2020-01-01T24:00:00", "2020-01-01T12:00",
+                            "2020-01-01T12:00:00.", "2020-01-01T12:00:00Zx", "2020-1-01"};
+    for (size_t i = 0; i < sizeof(badIso) / sizeof(badIso[0]); ++i)
+    {
+        if (oat::parseIso8601(badIso[i], parsed))
+        {
+            std::cout << "accepted bad ISO-8601 " << badIso[i] << std::endl;
+            return 1;
+        }
+    }
+    if (!oat::parseIso8601("2024-02-29 23:59:59.1234567", parsed) || parsed.day != 29 || parsed.microsecond != 123456 ||
+        !oat::parseIso8601("2024-02-29", parsed) || parsed.hour != 0)
+    {
+        std::cout << "rejected ISO-8601" << std::endl;
+        return 1;
+    }
     /*
     for (size_t i = 0; i < oribitData.size(); ++i)
     {